@@ -1,73 +1,238 @@
+#include <bit>
+#include <span>
+#include <array>
+#include <cstdint>
 #include <print>
 #include <ranges>
 #include <string>
 #include <format>
-#include <fstream>
-#include <iostream>
+#include <vector>
+#include <functional>
+#include <string_view>
 
-static constexpr std::string filename{"day_1_data.txt"}; 
-static constexpr std::array<std::string, 10> digit_names{
+#include "load_input.hpp"
+#include "line_engine.hpp"
+#include "stream_reader.hpp"
+#include "parse_numbers.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
+namespace day1{
+
+static constexpr std::string filename{"day_1_data.txt"};
+static constexpr std::array<std::string_view, 10> digit_names{
     "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"
 };
-static constexpr std::array<char, 10> digits{
-    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9'
-};
 
 // Digit filter
 bool isDigit(char c){
     return c >= '0' && c <= '9';
 };
 
-uint32_t problem1(std::ifstream& file){
-    
+// Aho-Corasick automaton matching the spelled digits "one" to "nine", built at compile time.
+// Input is reduced to 27 classes, a to z and then everything else, which always leads back
+// to the start. Digit characters are checked before the automaton is stepped
+struct DigitAutomaton{
+    static constexpr int max_states   = 40;
+    static constexpr int num_classes  = 27;
+    static constexpr int other_class  = 26;
+
+    std::array<std::array<uint8_t, num_classes>, max_states> next{};
+    std::array<uint8_t, max_states> match{};  // Value of the word ending in a state, 0 for none
+
+    static constexpr int charClass(char c){
+        const unsigned letter = static_cast<unsigned char>(c) - 'a';
+        return letter < 26 ? static_cast<int>(letter) : other_class;
+    }
+};
+
+// The reversed automaton matches the words spelled backwards, for scanning a line from its end
+constexpr DigitAutomaton buildDigitAutomaton(bool reversed){
+    DigitAutomaton dfa;
+    std::array<std::array<int, 26>, DigitAutomaton::max_states> trie{};
+    for (auto& children : trie) children.fill(-1);
+
+    // Trie of the words
+    int num_states = 1;
+    for (uint8_t value = 1; value <= 9; value++){
+        const std::string_view name = digit_names[value];
+        int state = 0;
+        for (size_t idx = 0; idx < name.size(); idx++){
+            const int letter = name[reversed ? name.size() - 1 - idx : idx] - 'a';
+            if (trie[state][letter] < 0) trie[state][letter] = num_states++;
+            state = trie[state][letter];
+        }
+        dfa.match[state] = value;
+    }
 
-    uint32_t sum = 0;
-    for (std::string line; std::getline(file, line);){
-        auto digits = line | std::views::filter(isDigit);
-        if (digits.empty()) continue;
-        char val[2] = {digits.front(), digits.back()};
-        sum += std::atoi(val);
+    // Breadth first over the trie, filling the missing edges from the failure links
+    std::array<int, DigitAutomaton::max_states> fail{};
+    std::array<int, DigitAutomaton::max_states> queue{};
+    size_t head = 0, tail = 0;
+    queue[tail++] = 0;
+    while (head < tail){
+        const int state = queue[head++];
+        if (dfa.match[state] == 0) dfa.match[state] = dfa.match[fail[state]];
+        for (int letter = 0; letter < 26; letter++){
+            const int child = trie[state][letter];
+            if (child < 0){
+                dfa.next[state][letter] = state == 0 ? 0 : dfa.next[fail[state]][letter];
+                continue;
+            }
+            fail[child] = state == 0 ? 0 : dfa.next[fail[state]][letter];
+            dfa.next[state][letter] = static_cast<uint8_t>(child);
+            queue[tail++] = child;
+        }
+        dfa.next[state][DigitAutomaton::other_class] = 0;
     }
-    return sum;
+    return dfa;
 }
 
-uint32_t problem2(std::ifstream& file){
-    uint32_t sum = 0;
+static constexpr DigitAutomaton forward_digits  = buildDigitAutomaton(false);
+static constexpr DigitAutomaton backward_digits = buildDigitAutomaton(true);
 
-    for (std::string line; std::getline(file, line);){
+// Value of the first digit, written or spelled, met walking chars in order, or -1. No word
+// contains another, so the first match to end is also the first to start
+template<typename Chars>
+int firstDigit(const Chars& chars, const DigitAutomaton& dfa){
+    uint8_t state = 0;
+    for (char c : chars){
+        if (isDigit(c)) return c - '0';
+        state = dfa.next[state][DigitAutomaton::charClass(c)];
+        if (dfa.match[state] != 0) return dfa.match[state];
+    }
+    return -1;
+}
+
+// Only reads up to the first digit from the front and the last digit from the back
+int64_t problem2(std::string_view line){
+    const int first = firstDigit(line, forward_digits);
+    if (first < 0) return 0;
+    return first*10 + firstDigit(line | std::views::reverse, backward_digits);
+}
 
-        // Transform all words to digits
-        for(std::span line_span(line); !line_span.empty(); line_span = line_span.subspan(1)){
-            std::string_view line_view(line_span);
-            for (auto [digit, name] : std::views::zip(digits, digit_names)){
-                if (line_view.starts_with(name))
-                    line_span[0] = digit;
+// Where a line lies in the text and where its first and last digits are, all as offsets
+// from the start of the text. first is npos for a line with no digits
+struct LineDigits{
+    size_t start = 0;
+    size_t end   = 0;
+    size_t first = std::string_view::npos;
+    size_t last  = 0;
+};
+
+// Call on_line(LineDigits) for every non-empty line in text[begin, end), which must start at
+// the start of a line. Digits and newlines are found 64 bytes at a time with vector compares,
+// and each line's first and last digit are read straight off the masks with bit scans
+template<typename F>
+void scanLines(std::string_view text, size_t begin, size_t end, F&& on_line){
+    LineDigits line{.start = begin};
+    auto finishLine = [&](size_t line_end){
+        line.end = line_end;
+        if (line.end != line.start) on_line(line);
+        line = LineDigits{.start = line_end + 1};
+    };
+
+    for (size_t block = begin; block < end; block += 64){
+        const char* p  = text.data() + block;
+        const size_t n = end - block;
+        uint64_t digits   = aoc::detail::digitMask64(p, n);
+        uint64_t newlines = aoc::detail::byteMask64(p, n, '\n');
+        while (true){
+            // Digits before the next newline belong to the current line
+            const uint64_t before_newline = newlines ? (newlines & -newlines) - 1 : ~0ull;
+            if (const uint64_t line_digits = digits & before_newline){
+                if (line.first == std::string_view::npos) line.first = block + std::countr_zero(line_digits);
+                line.last = block + 63 - std::countl_zero(line_digits);
             }
+            if (!newlines) break;
+
+            finishLine(block + std::countr_zero(newlines));
+            digits &= ~before_newline;
+            newlines &= newlines - 1;
         }
+    }
+    if (line.start < end) finishLine(end);
+}
 
-        // Apply the problem 1 solution
-        auto digits = line | std::views::filter(isDigit);
-        if (digits.empty()) continue;
-        char val[2] = {digits.front(), digits.back()};
-        sum += std::atoi(val);
+// Both parts for one line found by scanLines. A spelled digit can only win part 2 from
+// before the first digit or after the last one, so only those two ends of a line go
+// through the automata
+aoc::Answer calibrateLine(std::string_view text, const LineDigits& line){
+    if (line.first == std::string_view::npos){
+        return aoc::Answer{.part2 = problem2(text.substr(line.start, line.end - line.start))};
     }
+    const int first = text[line.first] - '0';
+    const int last  = text[line.last] - '0';
+    const int spelled_first = firstDigit(text.substr(line.start, line.first - line.start), forward_digits);
+    const int spelled_last  = firstDigit(text.substr(line.last + 1, line.end - line.last - 1) | std::views::reverse, backward_digits);
+    return aoc::Answer{
+        .part1 = first*10 + last,
+        .part2 = (spelled_first < 0 ? first : spelled_first)*10 + (spelled_last < 0 ? last : spelled_last)
+    };
+}
 
-    return sum;
+// Both parts for every line of text in one pass, for when the lines aren't kept
+aoc::Answer calibrate(std::string_view text){
+    aoc::Answer total;
+    scanLines(text, 0, text.size(), [&](const LineDigits& line){total = total + calibrateLine(text, line);});
+    return total;
 }
 
-int main(){
-    std::ifstream text_file(filename);
+struct Parsed{
+    std::string_view input;
+    std::vector<LineDigits> lines;
+};
 
-    // Problem 1
-    uint32_t sum1 = problem1(text_file);
-    std::println("The sum is {}", sum1);
+// The mask pass runs over chunks of the input in parallel, leaving solve only the digit
+// values and the automata
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    auto scanChunk = [&](std::string_view chunk){
+        std::vector<LineDigits> lines;
+        const size_t begin = chunk.data() - input.data();
+        scanLines(input, begin, begin + chunk.size(), [&](const LineDigits& line){lines.push_back(line);});
+        return lines;
+    };
+    auto append = [](std::vector<LineDigits> total, std::vector<LineDigits> lines){
+        if (total.empty()) return lines;
+        total.insert(total.end(), lines.begin(), lines.end());
+        return total;
+    };
+    return Parsed{.input = input, .lines = aoc::LineEngine{}.mapReduceChunks(input, scanChunk, append)};
+}
 
-    // Reset the file
-    text_file.clear();
-    text_file.seekg(std::ios_base::beg);
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    return aoc::LineEngine{}.mapReduceItems(std::span(parsed.lines), [&](const LineDigits& line){return calibrateLine(parsed.input, line);}, std::plus{});
+}
 
-    // Problem 2
-    std::println("Starting problem 2");
-    uint32_t sum2 = problem2(text_file);
-    std::println("The sum is {}", sum2);
-}
\ No newline at end of file
+// Same answers as parse and solve, reading the input a block at a time so memory use stays
+// constant however large it is. Reads straight through once, so pipes work too
+aoc::Answer solveStream(aoc::StreamReader& reader){
+    AOC_SCOPED_TIMER("solve");
+    const aoc::LineEngine engine;
+    aoc::Answer answer;
+    for (std::string_view block; !(block = reader.next()).empty();){
+        answer = answer + engine.mapReduceChunks(block, calibrate, std::plus{});
+    }
+    return answer;
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(1, parse, solve);
+}
+
+} // namespace day1
+
+#ifndef AOC_LIBRARY
+// Reads day_1_data.txt, the file given as the argument, or standard input when that is "-"
+int main(int argc, char** argv){
+    const std::string_view source = argc > 1 ? argv[1] : day1::filename;
+    aoc::StreamReader reader = source == "-" ? aoc::StreamReader(STDIN_FILENO) : aoc::StreamReader(std::string(source));
+    aoc::Answer answer = day1::solveStream(reader);
+
+    std::println("The sum is {}", answer.part1);
+    std::println("The sum is {}", answer.part2);
+    AOC_INSTRUMENT_REPORT(1, reader.bytesRead());
+}
+#endif
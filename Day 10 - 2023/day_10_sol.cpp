@@ -8,7 +8,15 @@
 #include <string_view>
 #include <unordered_map>
 
+#include "grid.hpp"
 #include "load_input.hpp"
+#include "log.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
+namespace day10{
+
+static constexpr std::string filename{"day_10_data.txt"};
 
 enum Dir{
     NORTH, 
@@ -20,30 +28,21 @@ enum Dir{
 struct Index{
     int x = 0;
     int y = 0;
+};
 
-    bool outOfBounds(int max_x, int max_y) const{
-        return x < 0 || x >= max_x|| y < 0|| y >= max_y;
-    }
-
-    bool operator!=(const Index& other) const{
-        return x != other.x || y != other.y;
-    }
-
-    bool operator==(const Index& other) const{
-        return x == other.x && y == other.y;
-    }
+// The grid is padded with '.' so stepping off the edge never connects to a pipe
+static constexpr char border = '.';
 
-    Index operator+(const Index& other) const{
-        return {x + other.x, y + other.y};
+// Flat offset of a single step in the given direction
+ptrdiff_t step(const Grid<char>& grid, Dir dir){
+    switch (dir){
+        case NORTH: return grid.north();
+        case SOUTH: return grid.south();
+        case EAST : return grid.east();
+        case WEST : return grid.west();
     }
-};
-
-static const std::unordered_map<Dir, Index> directions{
-    {NORTH, { 0, -1}},
-    {SOUTH, { 0,  1}},
-    {EAST , { 1,  0}},
-    {WEST , {-1,  0}}
-};
+    std::unreachable();
+}
 
 std::optional<Dir> getNext(char symbol, Dir last_move){
     Dir next_move;
@@ -98,12 +97,12 @@ static const std::unordered_map<char, char> remap{
 // Crossing a '-' on the path counts as crossing
 // Crossing a '|' on the path doesn't count as anything
 // Crossing any of these values not on the path doesn't count as anything
-bool isInside(Index idx, const std::vector<std::span<char>>& grid){
-    // Cast a ray upwards and see how many times we cross the loop
+bool isInside(ptrdiff_t pos, const Grid<char>& grid){
+    // Cast a ray upwards and see how many times we cross the loop, the border rows count as nothing
     size_t num_intersections = 0;
     char last_change = NONE;
-    for (; idx.y >= 0; idx.y--){
-        char test_char = grid[idx.y][idx.x];
+    for (; pos >= 0; pos += grid.north()){
+        char test_char = grid[pos];
         switch (test_char){
         case RIGHT:
             if (last_change == LEFT) {num_intersections++; last_change = NONE;}
@@ -126,31 +125,39 @@ bool isInside(Index idx, const std::vector<std::span<char>>& grid){
     return num_intersections % 2;
 }
 
-int main(){
-    const auto start_time = std::chrono::steady_clock::now();
-    std::string input = loadInput("day_10_data.txt");
-
+struct Parsed{
+    Grid<char> grid;
     Index start;
-    std::vector<std::span<char>> grid;
-    for (auto [idx, line] : input | std::views::split('\n') | std::views::enumerate){
-        auto pos = std::string_view(line).find('S');
-        if (pos != std::string_view::npos){
-            start.x = pos;
-            start.y = idx;
-        }
-        grid.push_back(line);
+};
+
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    Parsed parsed;
+    parsed.grid = Grid<char>::fromText(input, border);
+
+    const size_t start_pos = input.find('S');
+    const size_t line_len  = std::min(input.find('\n'), input.size());
+    if (start_pos != std::string_view::npos){
+        parsed.start.x = start_pos % (line_len + 1);
+        parsed.start.y = start_pos / (line_len + 1);
     }
-    std::println("Starting at index ({}, {})", start.x, start.y);
+    return parsed;
+}
+
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    // The loop is marked in place, so work on a copy of the grid
+    Grid<char> grid = parsed.grid;
+    const ptrdiff_t start = grid.offset(parsed.start.x, parsed.start.y);
 
     // Find the two starting pipes from S
     bool first_found = false;
     Dir path1_step, path2_step;
     for (const Dir dir : {NORTH, SOUTH, EAST, WEST}){
-        const Index next = start + directions.at(dir);
-        if (next.outOfBounds(grid.front().size(), grid.size())) continue;
+        const ptrdiff_t next = start + step(grid, dir);
 
         // Check to see if this character gives a valid move from S
-        std::optional<Dir> first_move = getNext(grid[next.y][next.x], dir);
+        std::optional<Dir> first_move = getNext(grid[next], dir);
         if (first_move && !first_found){
             path1_step = dir;
             first_found = true;
@@ -161,7 +168,7 @@ int main(){
     }
 
     // Determine the pipe type of S for part 2
-    char& start_char = grid[start.y][start.x];
+    char& start_char = grid[start];
     if (path1_step == NORTH){
         switch (path2_step){
             case SOUTH: start_char = NONE_VERTICAL; break;
@@ -178,12 +185,12 @@ int main(){
     }
 
     int64_t steps = 0;
-    for (Index idx1 = start, idx2 = start; (idx1 != idx2) || (steps == 0); steps++){
-        idx1 = idx1 + directions.at(path1_step);
-        idx2 = idx2 + directions.at(path2_step);
+    for (ptrdiff_t idx1 = start, idx2 = start; (idx1 != idx2) || (steps == 0); steps++){
+        idx1 += step(grid, path1_step);
+        idx2 += step(grid, path2_step);
 
-        char& c1 = grid[idx1.y][idx1.x];
-        char& c2 = grid[idx2.y][idx2.x];
+        char& c1 = grid[idx1];
+        char& c2 = grid[idx2];
 
         path1_step = getNext(c1, path1_step).value();
         path2_step = getNext(c2, path2_step).value();
@@ -194,17 +201,38 @@ int main(){
     }
 
     size_t num_inside = 0;
-    for (auto [y, line] : grid | std::views::enumerate){
+    for (int y = 0; y < grid.height(); y++){
+        std::span<char> line = grid.row(y);
         for (auto [x, c] : line | std::views::enumerate){
             if (c >= '1' && c <= '4') continue;
-            if (isInside(Index{(int)x, (int)y}, grid)) {c = 'X'; num_inside++;}
+            if (isInside(grid.offset(x, y), grid)) {c = 'X'; num_inside++;}
             else c = 'O';
         }
-        std::println("{}", std::string_view(line));
+        AOC_LOG(TRACE, "{}", std::string_view(line));
     }
 
+    return aoc::Answer{.part1 = steps, .part2 = static_cast<int64_t>(num_inside)};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(10, parse, solve);
+}
+
+} // namespace day10
+
+#ifndef AOC_LIBRARY
+int main(){
+    const auto start_time = std::chrono::steady_clock::now();
+    MappedInput input = mapInput(day10::filename);
+
+    day10::Parsed parsed = day10::parse(input);
+    std::println("Starting at index ({}, {})", parsed.start.x, parsed.start.y);
+    aoc::Answer answer = day10::solve(parsed);
+
     const auto stop_time = std::chrono::steady_clock::now();
-    std::println("Took {} steps", steps);
-    std::println("There are {} internal tiles", num_inside);
+    std::println("Took {} steps", answer.part1);
+    std::println("There are {} internal tiles", answer.part2);
     std::println("Computation tool {} microseconds", std::chrono::duration_cast<std::chrono::microseconds>(stop_time-start_time));
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(10, input.size());
+}
+#endif
@@ -6,25 +6,36 @@
 #include <algorithm>
 
 #include "load_input.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
+namespace day11{
+
+static constexpr std::string filename{"day_11_data.txt"};
 
 struct Index{
     int x;
     int y;
 };
 
-int main(){
-    std::string input_str = loadInput("day_11_data.txt");
-    const auto start_time = std::chrono::steady_clock::now();
+struct Parsed{
+    std::vector<Index> galaxy_indices;
+    std::vector<size_t> empty_row_indices;
+    std::vector<size_t> empty_col_indices;
+};
+
+Parsed parse(std::string_view input_str){
+    AOC_SCOPED_TIMER("parse");
+    Parsed parsed;
 
     // Get the size of each line
     const size_t line_length = input_str.find('\n');
 
-    std::vector<Index> galaxy_indices;
-    std::vector<size_t> empty_row_indices;
-    std::vector<size_t> empty_col_indices;
     for (auto [y_idx, row] : input_str | std::views::split('\n') | std::views::enumerate){
+        if (row.empty()) continue;
+
         // Check if this row has no galaxies
-        if (!std::ranges::contains(row, '#')) {empty_row_indices.push_back(y_idx); continue;}
+        if (!std::ranges::contains(row, '#')) {parsed.empty_row_indices.push_back(y_idx); continue;}
         
         // Get the indices of all '#' characters
         auto galaxy_positions = row 
@@ -34,14 +45,23 @@ int main(){
             | std::views::transform([y_idx](auto x_idx){return Index{(int)x_idx, (int)y_idx};});
         
         // Append these to the existing list of indices
-        std::ranges::copy(galaxy_positions, std::back_inserter(galaxy_indices));
+        std::ranges::copy(galaxy_positions, std::back_inserter(parsed.galaxy_indices));
     }
-    for (auto col_idx : std::views::iota(size_t(0), line_length)){
+    for (auto col_idx : std::views::iota(size_t(0), std::min(line_length, input_str.size()))){
         // Construct a column view and check to see if it has any galaxies
         auto col = input_str | std::views::drop(col_idx) | std::views::stride(line_length+1);
-        if (!std::ranges::contains(col, '#')) empty_col_indices.push_back(col_idx);
+        if (!std::ranges::contains(col, '#')) parsed.empty_col_indices.push_back(col_idx);
     }
 
+    return parsed;
+}
+
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const auto& galaxy_indices    = parsed.galaxy_indices;
+    const auto& empty_row_indices = parsed.empty_row_indices;
+    const auto& empty_col_indices = parsed.empty_col_indices;
+
     size_t total_dist = 0;
     for (auto [gal_idx, g1] : galaxy_indices | std::views::enumerate){
         for (auto g2 : galaxy_indices | std::views::drop(gal_idx+1)){
@@ -62,7 +82,26 @@ int main(){
         }
     }
 
+    return aoc::Answer{.part2 = static_cast<int64_t>(total_dist)};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(11, parse, solve);
+}
+
+} // namespace day11
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input_str = mapInput(day11::filename);
+    const auto start_time = std::chrono::steady_clock::now();
+
+    day11::Parsed parsed = day11::parse(input_str);
+    aoc::Answer answer = day11::solve(parsed);
+
     const auto stop_time = std::chrono::steady_clock::now();
-    std::println("Total distance is {}", total_dist);
+    std::println("Total distance is {}", answer.part2);
     std::println("Took {} microseconds", std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count());
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(11, input_str.size());
+}
+#endif
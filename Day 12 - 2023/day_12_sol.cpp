@@ -6,32 +6,52 @@
 #include <chrono>
 #include <random>
 #include <algorithm>
-#include <unordered_map>
+#include <functional>
 
 #include <assert.h>
 #include "load_input.hpp"
+#include "arena.hpp"
+#include "flat_hash_map.hpp"
+#include "line_engine.hpp"
+#include "stream_reader.hpp"
+#include "parse_numbers.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
+namespace day12{
+
+static constexpr std::string filename{"day_12_data.txt"};
+
+// The cache only lives as long as one record, so its keys can point into the record's
+// springs and chunk sizes rather than owning copies of them
+struct CacheKey{
+    std::string_view springs;
+    std::span<const int64_t> chunks;
+};
 
-typedef std::pair<std::string, std::vector<int64_t>> InputType;
-
-struct PairHash{
-    auto operator()(const InputType& pair) const{
-        return std::hash<std::string>{}(pair.first);
+struct CacheHash{
+    size_t operator()(const CacheKey& key) const {
+        size_t hash = std::hash<std::string_view>{}(key.springs);
+        for (int64_t chunk : key.chunks) hash = hash*31 + static_cast<size_t>(chunk);
+        return hash;
     }
 };
 
-struct PairEqual{
-    auto operator()(const InputType& pair1, const InputType& pair2) const{
-        return pair1.first == pair2.first && pair1.second == pair2.second;
+struct CacheEqual{
+    bool operator()(const CacheKey& key1, const CacheKey& key2) const {
+        return key1.springs == key2.springs && std::ranges::equal(key1.chunks, key2.chunks);
     }
 };
 
-int64_t processLine(std::string_view data, std::span<int64_t> chunk_sizes, int64_t level = 0){
+// Memo of arrangement counts, kept per record so records can be counted in parallel
+using Cache = aoc::pmr::FlatHashMap<CacheKey, int64_t, CacheHash, CacheEqual>;
+
+int64_t processLine(std::string_view data, std::span<const int64_t> chunk_sizes, Cache& cache, int64_t level = 0){
     // Handle caching
-    static std::unordered_map<InputType, int64_t, PairHash, PairEqual> cache;
-    std::vector<int64_t> chunk_vec(chunk_sizes.begin(), chunk_sizes.end());
-    auto pair_val = InputType{std::string(data), chunk_vec};
-    if (cache.contains(pair_val)){
-        return cache.at(pair_val);
+    const CacheKey key{data, chunk_sizes};
+    if (auto it = cache.find(key); it != cache.end()){
+        AOC_COUNT("cache_hits", 1);
+        return it->second;
     }
     
     // Extract the first chunk
@@ -57,18 +77,19 @@ int64_t processLine(std::string_view data, std::span<int64_t> chunk_sizes, int64
             if (chunk_sizes.size() == 1 && !remainder.contains('#')){
                 num_combinations++; 
             }else if (remainder.size() >= chunk_sizes[1]){
-                num_combinations += processLine(remainder.substr(1), chunk_sizes.subspan(1), level+1);
+                num_combinations += processLine(remainder.substr(1), chunk_sizes.subspan(1), cache, level+1);
             }
         }
 
         if (window.starts_with('#')) break;
     }
 
-    cache[pair_val] = num_combinations;
+    AOC_COUNT("cache_misses", 1);
+    cache.try_emplace(key, num_combinations);
     return num_combinations;
 }
 
-int64_t processLineBruteForce(std::string_view data, std::span<int64_t> chunk_sizes){
+int64_t processLineBruteForce(std::string_view data, std::span<const int64_t> chunk_sizes){
     const int num_questions = std::ranges::count(data, '?');
     const int num_iters = 1 << num_questions;
     int num_combinations = 0;
@@ -95,32 +116,78 @@ int64_t processLineBruteForce(std::string_view data, std::span<int64_t> chunk_si
     return num_combinations;
 }
 
-int main(){
-    std::string data_str = loadInput("day_12_data.txt");
-    auto start_time = std::chrono::steady_clock::now();
+// One row of springs and the sizes of its damaged groups
+struct Record{
+    std::string_view springs;
+    std::vector<int64_t> chunks;
+};
 
-    const bool part2 = true;
+Record parseRecord(std::string_view line){
+    // Divide the input into the two parts
+    auto divider = line.find(' ');
+    Record record{.springs = line.substr(0, divider)};
+    std::string_view chunk_list = line.substr(divider+1);
+    record.chunks.resize(chunk_list.size()/2 + 1);
+    record.chunks.resize(aoc::parseIntegers(chunk_list, std::span(record.chunks)));
+    return record;
+}
 
-    int64_t num_combinations = 0;
-    for (auto line : data_str | std::views::split('\n') | std::views::transform([](auto l){return std::string_view(l);})){
-        // Divide the input into the two parts
-        auto divider = line.find(' ');
-        auto data = line.substr(0, divider);
-        auto chunks = line.substr(divider+1) 
-            | std::views::split(',') 
-            | std::views::transform([](auto chars){return std::atoi(chars.data());})
-            | std::ranges::to<std::vector<int64_t>>();
-
-        if constexpr(part2){
-            std::string new_data = std::views::repeat(data, 5) | std::views::join_with('?') | std::ranges::to<std::string>();
-            std::vector<int64_t> new_chunks = std::views::repeat(chunks, 5) | std::views::join | std::ranges::to<std::vector<int64_t>>();
-            num_combinations += processLine(std::string_view(new_data), new_chunks);
-        }else{
-            num_combinations += processLine(data, chunks);
-        }
+static constexpr bool part2 = true;
+
+// Number of arrangements of a single record, unfolded for part 2
+int64_t countArrangements(const Record& record){
+    aoc::Arena arena;
+    Cache cache(&arena);
+    if constexpr(part2){
+        std::string new_data = std::views::repeat(record.springs, 5) | std::views::join_with('?') | std::ranges::to<std::string>();
+        std::vector<int64_t> new_chunks = std::views::repeat(record.chunks, 5) | std::views::join | std::ranges::to<std::vector<int64_t>>();
+        return processLine(std::string_view(new_data), new_chunks, cache);
+    }else{
+        return processLine(record.springs, record.chunks, cache);
     }
+}
+
+struct Parsed{
+    std::vector<Record> records;
+};
+
+// Records are split into springs and group sizes in parallel
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    return Parsed{.records = aoc::LineEngine{}.mapLines(input, parseRecord)};
+}
+
+// Records are independent, so counting them is one parallel pass. A record can take far
+// longer than its neighbours, so they are handed out a few at a time
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const int64_t num_combinations = aoc::LineEngine{}.mapReduceItems(std::span(parsed.records), countArrangements, std::plus{}, 16);
+    return part2 ? aoc::Answer{.part2 = num_combinations} : aoc::Answer{.part1 = num_combinations};
+}
+
+// Same answers as parse and solve, reading the input a block at a time so memory use stays
+// constant however large it is
+aoc::Answer solveStream(aoc::StreamReader& reader){
+    AOC_SCOPED_TIMER("solve");
+    const int64_t num_combinations = aoc::mapReduceStream(reader, [](std::string_view line){return countArrangements(parseRecord(line));}, std::plus{});
+    return part2 ? aoc::Answer{.part2 = num_combinations} : aoc::Answer{.part1 = num_combinations};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(12, parse, solve);
+}
+
+} // namespace day12
+
+#ifndef AOC_LIBRARY
+int main(){
+    auto start_time = std::chrono::steady_clock::now();
+    aoc::StreamReader reader(day12::filename);
+    aoc::Answer answer = day12::solveStream(reader);
 
     auto stop_time = std::chrono::steady_clock::now();
-    std::println("Total of {} combinations", num_combinations);
+    std::println("Total of {} combinations", answer.part1 + answer.part2);
     std::println("Took {} microseconds", std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count());
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(12, reader.bytesRead());
+}
+#endif
@@ -4,10 +4,16 @@
 #include <chrono>
 #include <vector>
 #include "load_input.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
 
 namespace views = std::ranges::views;
 using namespace std::string_view_literals;
 
+namespace day13{
+
+static constexpr std::string filename{"day_13_data.txt"};
+
 bool zipNotEqual(auto zip_view){
     return std::get<0>(zip_view) != std::get<1>(zip_view);
 }
@@ -37,24 +43,35 @@ bool checkSymmetryRow(R pattern, size_t idx, bool fix_smudge = false){
     return true;
 }
 
-int main(){
-    const bool part2 = true;
-    std::string input_str = loadInput("day_13_data.txt");
-    auto start_time = std::chrono::steady_clock::now();
+struct Parsed{
+    std::vector<std::vector<std::string_view>> patterns;
+};
 
+Parsed parse(std::string_view input_str){
+    AOC_SCOPED_TIMER("parse");
     // Split the input into individual patterns, each of which is a vector of string_views
-    auto patterns = input_str
-        | views::split("\n\n"sv)
-        | views::transform([](auto pattern){
-            return pattern
-            | views::split('\n')
-            | views::transform([](auto split_chunk){return std::string_view(split_chunk);})
-            | std::ranges::to<std::vector<std::string_view>>();
-        }
-    );
+    return Parsed{
+        .patterns = input_str
+            | views::split("\n\n"sv)
+            | views::transform([](auto pattern){
+                return pattern
+                | views::split('\n')
+                | views::transform([](auto split_chunk){return std::string_view(split_chunk);})
+                | views::filter([](std::string_view line){return !line.empty();})
+                | std::ranges::to<std::vector<std::string_view>>();
+            })
+            | std::ranges::to<std::vector>()
+    };
+}
+
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const bool part2 = true;
 
     size_t total = 0;
-    for (auto lines : patterns){
+    for (const auto& lines : parsed.patterns){
+        if (lines.empty()) continue;
+
         // Extract the features of this pattern
         const int line_length = lines.front().size();
         const int num_lines   = std::ranges::distance(lines);
@@ -90,7 +107,27 @@ int main(){
         }
     }
 
+    const int64_t result = static_cast<int64_t>(total);
+    return part2 ? aoc::Answer{.part2 = result} : aoc::Answer{.part1 = result};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(13, parse, solve);
+}
+
+} // namespace day13
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input_str = mapInput(day13::filename);
+    auto start_time = std::chrono::steady_clock::now();
+
+    day13::Parsed parsed = day13::parse(input_str);
+    aoc::Answer answer = day13::solve(parsed);
+
     auto stop_time = std::chrono::steady_clock::now();
-    std::println("Total was {}", total);
+    std::println("Total was {}", answer.part1 + answer.part2);
     std::println("Calculations took {} microseconds", std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count());
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(13, input_str.size());
+}
+#endif
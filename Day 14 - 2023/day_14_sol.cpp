@@ -4,12 +4,19 @@
 #include <chrono>
 #include <vector>
 #include <algorithm>
-#include <unordered_map>
+#include "grid.hpp"
 #include "load_input.hpp"
+#include "flat_hash_map.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
 
 namespace ranges = std::ranges;
 namespace views  = std::ranges::views;
 
+namespace day14{
+
+static constexpr std::string filename{"day_14_data.txt"};
+
 enum Direction{
     NORTH, 
     EAST, 
@@ -32,97 +39,112 @@ void tilt_impl(Range grid){
     }
 }
 
-void tilt(std::vector<std::span<char>>& grid, Direction dir){
-    // Transpose the grid for a column view
-    int num_cols = grid[0].size();
-    auto cols = views::iota(0, num_cols) | views::transform(
-        [&](int i){
-            return grid 
-                | views::join
-                | views::drop(i)
-                | views::stride(num_cols);
-        }
-    );
-
+void tilt(Grid<char>& grid, Direction dir){
     // Have to use an impl function because the type passed to it is different in every case
     switch (dir){
         default:
         case NORTH:
-            tilt_impl(cols);
+            tilt_impl(grid.cols());
             return;
         
         case EAST:
-            tilt_impl(grid | views::transform([](auto row){return row | views::reverse;}));
+            tilt_impl(grid.rows() | views::transform([](auto row){return row | views::reverse;}));
             return;
 
         case SOUTH:
-            tilt_impl(cols | views::transform([](auto col){return col | views::reverse;}));
+            tilt_impl(grid.cols() | views::transform([](auto col){return col | views::reverse;}));
             return;
             
         case WEST:
-            tilt_impl(grid | views::all);
+            tilt_impl(grid.rows());
             return;
     }
 }
 
 // Calculate the weight on the north beam
-int evaluate(std::vector<std::span<char>>& grid){
+int evaluate(const Grid<char>& grid){
     int total = 0;
-    for (auto [idx, row] : grid | views::reverse | views::enumerate){
+    for (auto [idx, row] : grid.rows() | views::reverse | views::enumerate){
         total += ranges::count(row, 'O') * (idx+1);
     }
     return total;
 }
 
-int main(){
-    std::string input_str = loadInput("day_14_data.txt");
-    auto start_time = std::chrono::steady_clock::now();
+struct Parsed{
+    Grid<char> grid;
+};
+
+// The grid is padded with cube rocks, which is exactly how the edges behave when tilting
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    return Parsed{.grid = Grid<char>::fromText(input, '#')};
+}
 
-    // Prepare the data
-    auto rows = input_str | views::split('\n') | ranges::to<std::vector<std::span<char>>>();
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    // Rocks are tilted in place, so work on a copy of the grid
+    Grid<char> grid = parsed.grid;
 
     // Part 1
-    std::string input_copy{input_str};
-    tilt(rows, NORTH);
-    size_t part1_total = evaluate(rows);
-    input_str = input_copy;
+    tilt(grid, NORTH);
+    size_t part1_total = evaluate(grid);
+    grid = parsed.grid;
 
     // Part 2
     const size_t num_cycles = 1'000'000'000;
     auto cycle = [&](){
-        tilt(rows, NORTH);
-        tilt(rows, WEST) ;
-        tilt(rows, SOUTH);
-        tilt(rows, EAST) ;
+        tilt(grid, NORTH);
+        tilt(grid, WEST) ;
+        tilt(grid, SOUTH);
+        tilt(grid, EAST) ;
     };
 
-    // Keep track of previous states to detect if we enter a cycle of states
-    std::unordered_map<std::string, size_t> known_states;
+    // Keep track of previous states to detect if we enter a cycle of states. States are looked up
+    // through a view of the grid and only copied into the map when they're new
+    aoc::FlatHashMap<std::string, size_t> known_states;
     for (size_t i = 0; i < num_cycles; i++){
-        
+        const std::string_view state(grid.data().data(), grid.data().size());
+
         // Check for a repeated state. If one is found, we have a cycle
-        if (known_states.contains(input_str)){
+        if (auto known = known_states.find(state); known != known_states.end()){
             // Calculate the properties of the state cycle
-            const size_t cycle_start_idx = known_states[input_str];
+            const size_t cycle_start_idx = known->second;
             const size_t cycle_frequency = i - cycle_start_idx;
-            const size_t target_index    = (num_cycles - cycle_start_idx) % cycle_frequency;
+            const size_t target_index    = cycle_start_idx + (num_cycles - cycle_start_idx) % cycle_frequency;
 
             // Extract the state that matches with the final target state
-            auto target_state = known_states 
-                | views::drop(cycle_start_idx) 
-                | views::drop_while([&](auto pair){return pair.second - cycle_start_idx != target_index;})
-                | views::take(1);
-            input_str = target_state.front().first;
+            auto target_state = ranges::find_if(known_states, [&](const auto& entry){return entry.second == target_index;});
+            ranges::copy(target_state->first, grid.data().begin());
             break;
         }
 
         // Record the current state and cycle again
-        known_states.insert({input_str, i});
+        known_states.try_emplace(state, i);
         cycle();
+        AOC_COUNT("spin_cycles", 1);
     }
 
+    return aoc::Answer{.part1 = static_cast<int64_t>(part1_total), .part2 = evaluate(grid)};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(14, parse, solve);
+}
+
+} // namespace day14
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input = mapInput(day14::filename);
+    auto start_time = std::chrono::steady_clock::now();
+
+    day14::Parsed parsed = day14::parse(input);
+    aoc::Answer answer = day14::solve(parsed);
+
     auto stop_time = std::chrono::steady_clock::now();
-    std::println("Part 1 total is {}", part1_total);
-    std::println("Part 2 total is {}", evaluate(rows));
+    std::println("Part 1 total is {}", answer.part1);
+    std::println("Part 2 total is {}", answer.part2);
     std::println("Calculations took {} milliseconds", std::chrono::duration_cast<std::chrono::milliseconds>(stop_time - start_time).count());
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(14, input.size());
+}
+#endif
@@ -5,42 +5,64 @@
 #include <ranges>
 #include <string>
 #include <chrono>
+#include <vector>
 #include <algorithm>
 #include "load_input.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
 
 namespace views = std::views;
 namespace ranges = std::ranges;
 
+namespace day15{
+
+static constexpr std::string filename{"day_15_data.txt"};
+
 using Slot = std::pair<std::string, int>;
 using Box  = std::list<Slot>;
 
-int main(){
-    std::string input_str = loadInput("day_15_data.txt");
-    auto start = std::chrono::steady_clock::now();
+int64_t hashFn(std::string_view str){
+    int64_t val = 0;
+    for (char c : str){
+        val += static_cast<int>(c);
+        val *= 17;
+        val %= 256;
+    }
+    return val;
+}
+
+struct Parsed{
+    std::vector<std::string_view> steps;
+};
+
+Parsed parse(std::string_view input_str){
+    AOC_SCOPED_TIMER("parse");
+    if (input_str.ends_with('\n')) input_str.remove_suffix(1);
 
     // Convert the inputs into its constituent chunks
-    auto inputs = input_str | views::split(',');
+    return Parsed{
+        .steps = input_str 
+            | views::split(',') 
+            | views::transform([](auto chunk){return std::string_view(chunk);})
+            | ranges::to<std::vector>()
+    };
+}
+
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const std::vector<std::string_view>& inputs = parsed.steps;
 
     // Part 1
-    auto hashFn = [](std::span<char> str) -> int64_t {
-        int64_t val = 0;
-        for (char c : str){
-            val += static_cast<int>(c);
-            val *= 17;
-            val %= 256;
-        }
-        return val;
-    };
-    auto result = ranges::fold_left(inputs | views::transform(hashFn), 0, std::plus{});
+    auto result = ranges::fold_left(inputs | views::transform(hashFn), int64_t(0), std::plus{});
 
     // Part 2
     std::array<Box, 256> map{};
-    auto hashMapFn = [&](std::span<char> str) -> void {
+    auto hashMapFn = [&](std::string_view str) -> void {
         // Transform the input to the values we need
         std::string label = str | views::take_while([](char c){return c != '-' && c != '=';}) | ranges::to<std::string>();
         int box_number    = hashFn(label);
         char action       = (str | views::reverse | views::drop(1)).front();
-        int focal_length  = std::atoi(&str.back());
+        int focal_length  = str.back() - '0';
 
         // Check to see if this already exists
         Box& box = map[box_number];
@@ -67,8 +89,27 @@ int main(){
         }
     }
 
+    return aoc::Answer{.part1 = result, .part2 = static_cast<int64_t>(focusing_power)};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(15, parse, solve);
+}
+
+} // namespace day15
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input_str = mapInput(day15::filename);
+    auto start = std::chrono::steady_clock::now();
+
+    day15::Parsed parsed = day15::parse(input_str);
+    aoc::Answer answer = day15::solve(parsed);
+
     auto stop = std::chrono::steady_clock::now();
-    std::println("Answer is {}", result);
-    std::println("Focusing power is {}", focusing_power);
+    std::println("Answer is {}", answer.part1);
+    std::println("Focusing power is {}", answer.part2);
     std::println("Calculations took {} microseconds", std::chrono::duration_cast<std::chrono::microseconds>(stop-start).count());
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(15, input_str.size());
+}
+#endif
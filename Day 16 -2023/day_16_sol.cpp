@@ -4,12 +4,19 @@
 #include <chrono>
 #include <optional>
 #include <algorithm>
-#include <unordered_map>
+#include "grid.hpp"
 #include "load_input.hpp"
+#include "flat_hash_map.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
 
 namespace views = std::views;
 namespace ranges = std::ranges;
 
+namespace day16{
+
+static constexpr std::string filename{"day_16_data.txt"};
+
 enum Direction{
     NORTH,
     EAST,
@@ -24,7 +31,7 @@ struct Index{
 
 struct IndexHash{
     size_t operator()(const Index& idx) const {
-        return (std::hash<int>{}(idx.x) << 1) ^ (std::hash<int>{}(idx.y));
+        return (static_cast<size_t>(static_cast<uint32_t>(idx.x)) << 32) | static_cast<uint32_t>(idx.y);
     }
 };
 
@@ -72,22 +79,28 @@ std::pair<Direction, std::optional<Direction>> updateDirection(Direction dir, ch
     std::unreachable();
 }
 
-int main(){
-    std::string input_str = loadInput("day_16_data.txt");
-    auto start = std::chrono::steady_clock::now();
+// Cells outside the contraption, a beam reaching one has left the grid
+static constexpr char edge = '\0';
 
-    // Get a double indexable grid of characters
-    auto rows = input_str 
-        | views::split('\n') 
-        | views::transform([](auto line){return std::span<char>(line);}) 
-        | ranges::to<std::vector>();
-    const int x_dim = rows[0].size();
-    const int y_dim = rows.size();
+struct Parsed{
+    Grid<char> grid;
+};
 
-    // Use a multimap to keep track of energized states
+Parsed parse(std::string_view input_str){
+    AOC_SCOPED_TIMER("parse");
+    return Parsed{.grid = Grid<char>::fromText(input_str, edge)};
+}
+
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const Grid<char>& grid = parsed.grid;
+    const int x_dim = grid.width();
+    const int y_dim = grid.height();
+
+    // Map each energized cell to a bitmask of the directions beams have passed through it in
     Index start_state{.x = -1, .y = 0};
     Direction start_direction = EAST;
-    std::unordered_multimap<Index, Direction, IndexHash, IndexEqual> energized_states{};
+    aoc::FlatHashMap<Index, uint8_t, IndexHash, IndexEqual> energized_states{};
 
     // Recursive lambda to cast a beam in the grid
     auto castBeam = [&]<typename Self>(this const Self& self, Index idx, Direction dir) -> void {
@@ -95,23 +108,24 @@ int main(){
         const auto [dx, dy] = travel(dir);
         idx.x += dx;
         idx.y += dy;
-        if (idx.x < 0 || idx.x >= x_dim || idx.y < 0 || idx.y >= y_dim) return;
+        const char next_char = grid(idx.x, idx.y);
+        if (next_char == edge) return;
         
         // Check to see if this state has already been visited
-        auto [start, end] = energized_states.equal_range(idx);
-        bool already_visited = ranges::contains(ranges::subrange(start, end) | views::values, dir);
-        if (already_visited) return;
+        uint8_t& visited_dirs = energized_states.try_emplace(idx, uint8_t{0}).first->second;
+        if (visited_dirs & (1 << dir)) return;
 
         // Determine what the new direction will be when leaving this state
-        energized_states.insert({idx, dir});
-        auto [dir1, dir2] = updateDirection(dir, rows[idx.y][idx.x]);
+        visited_dirs |= (1 << dir);
+        AOC_COUNT("beam_steps", 1);
+        auto [dir1, dir2] = updateDirection(dir, next_char);
         self(idx, dir1);
         if (dir2) self(idx, *dir2);
     };
     castBeam(start_state, start_direction);
 
     // Count the number of energized states
-    auto num_energized = ranges::distance(energized_states | views::keys | views::chunk_by(IndexEqual{}));
+    auto num_energized = static_cast<int64_t>(energized_states.size());
 
     // Part 2 - Do the same for all the starting positions
     auto top_start   = views::iota(0, x_dim) | views::transform([&](int i){return Index{i, -1};});
@@ -124,7 +138,7 @@ int main(){
                               (idx.x == x_dim) ? WEST  : 
                               (idx.y == -1)    ? SOUTH : NORTH;
         castBeam(idx, start_dir);
-        return ranges::distance(energized_states | views::keys | views::chunk_by(IndexEqual{}));
+        return static_cast<int64_t>(energized_states.size());
     };
 
     // Find the maximum value
@@ -135,8 +149,27 @@ int main(){
         ranges::max(right_start | views::transform(count_energized))
     });
 
+    return aoc::Answer{.part1 = num_energized, .part2 = max_energized};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(16, parse, solve);
+}
+
+} // namespace day16
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input_str = mapInput(day16::filename);
+    auto start = std::chrono::steady_clock::now();
+
+    day16::Parsed parsed = day16::parse(input_str);
+    aoc::Answer answer = day16::solve(parsed);
+
     auto stop = std::chrono::steady_clock::now();
-    std::println("Done, energizing {} states", num_energized);
-    std::println("Maximum energization is {}", max_energized);
+    std::println("Done, energizing {} states", answer.part1);
+    std::println("Maximum energization is {}", answer.part2);
     std::println("Calculations took {} milliseconds", std::chrono::duration_cast<std::chrono::milliseconds>(stop-start).count());
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(16, input_str.size());
+}
+#endif
@@ -1,16 +1,25 @@
 #include <print>
 #include <array>
 #include <queue>
+#include <vector>
 #include <ranges>
 #include <string>
 #include <chrono>
 #include <optional>
-#include <unordered_map>
+#include "grid.hpp"
 #include "load_input.hpp"
+#include "arena.hpp"
+#include "flat_hash_map.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
 
 namespace views = std::views;
 namespace ranges = std::ranges;
 
+namespace day17{
+
+static constexpr std::string filename{"day_17_data.txt"};
+
 // Problem configuration
 static constexpr bool part2 = true;
 static constexpr int min_steps = part2 ? 4 : 0;
@@ -56,8 +65,10 @@ struct State{
 };
 
 struct HashState{
-    auto operator()(const State& s) const{
-        return (std::hash<int>{}(s.idx.xi) << 1) ^ std::hash<int>{}(s.idx.yi);
+    size_t operator()(const State& s) const{
+        return (static_cast<size_t>(static_cast<uint32_t>(s.idx.xi)) << 32)
+             ^ (static_cast<size_t>(static_cast<uint32_t>(s.idx.yi)) << 8)
+             ^ (static_cast<size_t>(s.dir) << 6) ^ s.step_count;
     }
 };
 
@@ -112,14 +123,16 @@ Index travel(Index idx, Direction dir){
     return idx;
 }
 
+// Cost stored in the cells around the city, moving onto one is never allowed
+static constexpr uint8_t wall = UINT8_MAX;
+
 // Gather all valid neighbours considering grid bounds and step limits
-std::array<std::optional<State>, 3> getNeighbours(const State& s, const std::vector<std::vector<uint8_t>>& grid){
+std::array<std::optional<State>, 3> getNeighbours(const State& s, const Grid<uint8_t>& grid){
     std::array<std::optional<State>, 3> ret_val{};
-    if (grid.empty()) return ret_val;
 
-    // Bounds checking lambda
+    // The border of walls takes care of bounds checking
     auto inRange = [&grid](const Index& idx) -> bool {
-        return idx.xi >= 0 && idx.yi >=0 && idx.yi < grid.size() && idx.xi < grid.front().size();
+        return grid(idx.xi, idx.yi) != wall;
     };
 
     // Get the three potential next states
@@ -132,7 +145,7 @@ std::array<std::optional<State>, 3> getNeighbours(const State& s, const std::vec
     if (s.step_count < max_steps && inRange(forward)) {
         ret_val[0] = State{
             .idx        = forward,
-            .cost       = s.cost + grid[forward.yi][forward.xi], 
+            .cost       = s.cost + grid(forward.xi, forward.yi), 
             .dir        = s.dir, 
             .step_count = static_cast<uint8_t>(s.step_count + 1),
         };
@@ -142,7 +155,7 @@ std::array<std::optional<State>, 3> getNeighbours(const State& s, const std::vec
     if ((s.step_count == 0 || s.step_count >= min_steps) && inRange(step1)){
         ret_val[1] = State{
             .idx        = step1,
-            .cost       = s.cost + grid[step1.yi][step1.xi], 
+            .cost       = s.cost + grid(step1.xi, step1.yi), 
             .dir        = side1, 
             .step_count = 1,
         };
@@ -151,7 +164,7 @@ std::array<std::optional<State>, 3> getNeighbours(const State& s, const std::vec
     if ((s.step_count == 0 || s.step_count >= min_steps) && inRange(step2)){
         ret_val[2] = State{
             .idx        = step2,
-            .cost       = s.cost + grid[step2.yi][step2.xi], 
+            .cost       = s.cost + grid(step2.xi, step2.yi), 
             .dir        = side2, 
             .step_count = 1,
         };
@@ -163,25 +176,28 @@ std::array<std::optional<State>, 3> getNeighbours(const State& s, const std::vec
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 
-int main(){
-    std::string input_str = loadInput("day_17_data.txt");
-    const auto start_time = std::chrono::steady_clock::now();
+struct Parsed{
+    Grid<uint8_t> grid;
+};
 
-    // Convert the input to a vector of vectors of uint8_t's
-    const auto grid = input_str 
-        | views::split('\n')
-        | views::transform([](auto line){
-            return line 
-                | views::transform([](char c){return static_cast<uint8_t>(c - '0');})
-                | ranges::to<std::vector>();
-        })
-        | ranges::to<std::vector>();
+Parsed parse(std::string_view input_str){
+    AOC_SCOPED_TIMER("parse");
+    // Convert the input to a grid of uint8_t's
+    return Parsed{
+        .grid = Grid<uint8_t>::fromText(input_str, wall, [](char c){return static_cast<uint8_t>(c - '0');})
+    };
+}
 
-    // Use Dijkstra
-    std::priority_queue<State, std::vector<State>, CostGreater> queue;
-    std::unordered_map<State, int, HashState, EqualState> visited_states;
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const auto& grid = parsed.grid;
 
-    const Index goal_index{(int)(grid.front().size()-1), (int)(grid.size() - 1)};
+    // Use Dijkstra, with the frontier and visited states allocated from one arena for the run
+    aoc::Arena arena;
+    std::priority_queue<State, std::pmr::vector<State>, CostGreater> queue{CostGreater{}, std::pmr::vector<State>(&arena)};
+    aoc::pmr::FlatHashMap<State, int, HashState, EqualState> visited_states(&arena);
+
+    const Index goal_index{grid.width() - 1, grid.height() - 1};
 
     // Start it off with the initial state
     queue.push(State{.idx = Index{0, 0}, .cost = 0, .dir = EAST, .step_count = 0});
@@ -193,18 +209,41 @@ int main(){
         if (curr.idx == goal_index && curr.step_count >= min_steps) break;
 
         queue.pop();
+        AOC_COUNT("nodes_expanded", 1);
         for (std::optional<State>& candidate : getNeighbours(curr, grid)){
-            if ( !candidate.has_value() || 
-                (visited_states.contains(*candidate) && candidate->cost >= visited_states.at(*candidate))
-            ) continue;
+            if (!candidate.has_value()) continue;
 
-            visited_states[*candidate] = candidate->cost;
+            auto [known, inserted] = visited_states.try_emplace(*candidate, candidate->cost);
+            if (!inserted){
+                if (candidate->cost >= known->second) continue;
+                known->second = candidate->cost;
+            }
             queue.push(*candidate);
+            AOC_COUNT("nodes_pushed", 1);
         }
     }
 
+    const int64_t min_cost = queue.empty() ? 0 : queue.top().cost;
+    return part2 ? aoc::Answer{.part2 = min_cost} : aoc::Answer{.part1 = min_cost};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(17, parse, solve);
+}
+
+} // namespace day17
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input_str = mapInput(day17::filename);
+    const auto start_time = std::chrono::steady_clock::now();
+
+    day17::Parsed parsed = day17::parse(input_str);
+    aoc::Answer answer = day17::solve(parsed);
+
     const auto stop_time = std::chrono::steady_clock::now();
-    const State& final_state = queue.top();
-    std::println("Min cost is {} and the final state is at ({}, {})", final_state.cost, final_state.idx.xi, final_state.idx.yi);
+    std::println("Min cost is {}", answer.part1 + answer.part2);
     std::println("Calculations took {} milliseconds", std::chrono::duration_cast<std::chrono::milliseconds>(stop_time - start_time).count());
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(17, input_str.size());
+}
+#endif
@@ -4,12 +4,21 @@
 #include <ranges>
 #include <string>
 #include <chrono>
+#include <vector>
 #include <algorithm>
 #include "load_input.hpp"
+#include "line_engine.hpp"
+#include "parse_numbers.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
 
 namespace views = std::views;
 namespace ranges = std::ranges;
 
+namespace day18{
+
+static constexpr std::string filename{"day_18_data.txt"};
+
 struct Index{
     int64_t x{0};
     int64_t y{0};
@@ -28,14 +37,18 @@ struct CompIndex{
     }
 };
 
+} // namespace day18
+
 template<>
-struct std::formatter<Index>{
+struct std::formatter<day18::Index>{
     constexpr auto parse(std::format_parse_context& ctx){return ctx.begin();}
-    auto format(const Index& idx, std::format_context& ctx) const {
+    auto format(const day18::Index& idx, std::format_context& ctx) const {
         return std::format_to(ctx.out(), "({}, {})", idx.x, idx.y);
     }
 };
 
+namespace day18{
+
 using Shape = std::list<Index>;
 using ShapeIterator = Shape::iterator;
 
@@ -53,7 +66,7 @@ struct Node{
     size_t color_code;
 };
 
-Node parseLine(std::span<char> line){
+Node parseLine(std::span<const char> line){
     Node output;
     auto segments = line | views::split(' ');
     
@@ -66,11 +79,11 @@ Node parseLine(std::span<char> line){
 
     // Assign the step count
     auto count_label = *ranges::next(segments.begin(), 1);
-    output.step_count = std::atoll(count_label.data());
+    output.step_count = aoc::parseInteger<size_t>(std::string_view(count_label));
 
     // Assign the hex color code
     auto color_label  = *ranges::next(segments.begin(), 2) | views::drop(2) | views::take(6);
-    output.color_code = std::stoll(std::string(std::string_view(color_label)), nullptr, 16);
+    output.color_code = aoc::parseHex(std::string_view(color_label));
 
     return output;
 }
@@ -209,16 +222,21 @@ std::pair<size_t, bool> slice(Shape& shape) {
     return {area, needs_split};
 };
 
-int main(){
-    std::string input_str = loadInput("day_18_data.txt");
-    const auto start_time = std::chrono::steady_clock::now();
+struct Parsed{
+    std::vector<Node> nodes;
+};
+
+Parsed parse(std::string_view input_str){
+    AOC_SCOPED_TIMER("parse");
+    return Parsed{.nodes = aoc::LineEngine{}.mapLines(input_str, parseLine)};
+}
 
-    auto nodes = input_str 
-        | views::split('\n') 
-        | views::transform(parseLine)
-        | ranges::to<std::vector>();
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    std::vector<Node> nodes = parsed.nodes;
 
-    if (auto part2 = true)
+    constexpr bool part2 = true;
+    if constexpr (part2)
         ranges::for_each(nodes, reinterpretNode);
 
     // Define the vertices of our outline
@@ -239,7 +257,43 @@ int main(){
         }
     }
 
+    const int64_t result = static_cast<int64_t>(total);
+    return part2 ? aoc::Answer{.part2 = result} : aoc::Answer{.part1 = result};
+}
+
+// Parse cache layout: the dig plan as (direction, step count, colour code) triples. Nodes
+// aren't written directly as the padding after their direction would be saved uninitialised
+void save(const Parsed& parsed, std::string_view /*input*/, aoc::cache::Writer& writer){
+    writer.writeArray(parsed.nodes
+        | views::transform([](const Node& node){return std::array<uint64_t, 3>{static_cast<uint64_t>(node.dir), node.step_count, node.color_code};})
+        | ranges::to<std::vector>());
+}
+
+Parsed load(aoc::cache::Reader& reader, std::string_view /*input*/){
+    Parsed parsed;
+    for (auto [dir, step_count, color_code] : reader.readArray<std::array<uint64_t, 3>>()){
+        parsed.nodes.push_back(Node{.dir = static_cast<Direction>(dir), .step_count = step_count, .color_code = color_code});
+    }
+    return parsed;
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(18, parse, solve, aoc::cache::CacheIO<Parsed>{.schema_version = 2, .save = save, .load = load});
+}
+
+} // namespace day18
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input_str = mapInput(day18::filename);
+    const auto start_time = std::chrono::steady_clock::now();
+
+    day18::Parsed parsed = day18::parse(input_str);
+    aoc::Answer answer = day18::solve(parsed);
+
     const auto stop_time = std::chrono::steady_clock::now();
-    std::println("Total is {}", total);
+    std::println("Total is {}", answer.part1 + answer.part2);
     std::println("Calculations took {} microseconds", std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count());
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(18, input_str.size());
+}
+#endif
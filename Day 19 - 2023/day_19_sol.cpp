@@ -4,14 +4,25 @@
 #include <ranges>
 #include <chrono>
 #include <vector>
+#include <memory>
 #include <algorithm>
+#include <stdexcept>
+#include <type_traits>
 #include <functional>
-#include <unordered_map>
 #include "load_input.hpp"
+#include "arena.hpp"
+#include "flat_hash_map.hpp"
+#include "parse_numbers.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
 
 namespace views = std::ranges::views;
 namespace ranges = std::ranges;
 
+namespace day19{
+
+static constexpr std::string filename{"day_19_data.txt"};
+
 enum PartType : char{
     X = 'x',
     M = 'm',
@@ -19,45 +30,51 @@ enum PartType : char{
     S = 's'
 };
 
+// Slot of each part type in a rating
+constexpr size_t slot(char type){
+    switch (type){
+        case X: return 0;
+        case M: return 1;
+        case A: return 2;
+        case S: return 3;
+    }
+    std::unreachable();
+}
+
 struct Rating{
-    std::unordered_map<char, int64_t> data{
-        {X, 0},
-        {M, 0},
-        {A, 0},
-        {S, 0},
-    };
+    std::array<int64_t, 4> data{};
+    int64_t& operator[](char type)       {return data[slot(type)];}
+    int64_t  operator[](char type) const {return data[slot(type)];}
 };
 
 // Range of what a rating can be, inclusive on both ends
 struct RatingRange{
-    Rating lower{{
-        {X, 1},
-        {M, 1},
-        {A, 1},
-        {S, 1},
-    }};
-    Rating upper{{
-        {X, 4000},
-        {M, 4000},
-        {A, 4000},
-        {S, 4000},
-    }};
+    Rating lower{{1, 1, 1, 1}};
+    Rating upper{{4000, 4000, 4000, 4000}};
 };
 
+// Labels point into the input, which outlives the parsed data
 struct Rule{
     PartType type;
-    std::function<bool(int64_t, int64_t)> comparator;
+    bool greater;
     int64_t limit;
-    std::string destination;
+    std::string_view destination;
+
+    // Whether a rating value passes the comparison against the limit
+    bool test(int64_t value) const {
+        return greater ? value > limit : value < limit;
+    }
 };
 
 struct Workflow{
-    std::vector<Rule> rules;
-    std::string final;
+    std::pmr::vector<Rule> rules;
+    std::string_view final;
 };
 
-std::unordered_map<std::string_view, Workflow> parseWorkflows(const std::string& input){
-    std::unordered_map<std::string_view, Workflow> workflows;
+using Workflows = aoc::pmr::FlatHashMap<std::string_view, Workflow>;
+
+Workflows parseWorkflows(std::string_view input, std::pmr::memory_resource* arena){
+    Workflows workflows(arena);
     for (auto workflow_str : input | views::split('\n')){
         if (workflow_str.empty()) break;
         
@@ -65,26 +82,22 @@ std::unordered_map<std::string_view, Workflow> parseWorkflows(const std::string&
         auto sections = workflow_str | views::split('{') | ranges::to<std::vector>();
         std::string_view label{sections[0]};
         std::string_view rules{sections[1]};
-        Workflow& workflow = workflows[label];
+        Workflow& workflow = workflows.try_emplace(label, Workflow{.rules = std::pmr::vector<Rule>(arena)}).first->second;
 
         // Find the final destination of this workflow
         size_t last_comma = rules.find_last_of(",");
         std::string_view final_destination = rules.substr(last_comma + 1);
         final_destination.remove_suffix(1);
-        workflow.final = std::string(final_destination);
+        workflow.final = final_destination;
 
         // Assign the rules
         rules = rules.substr(0, last_comma);
         for (auto rule_str : rules | views::split(',') | views::transform([](auto rule){return std::string_view(rule);})){
             Rule new_rule;
             new_rule.type  = static_cast<PartType>(rule_str[0]);
-            new_rule.limit = std::atoll(rule_str.substr(2).data());
-            new_rule.destination = std::string(rule_str.substr(rule_str.find(':') + 1));
-            if (rule_str[1] == '>'){
-                new_rule.comparator = std::greater<int64_t>{};
-            }else{
-                new_rule.comparator = std::less<int64_t>{};
-            }
+            new_rule.limit = aoc::parseInteger<int64_t>(rule_str.substr(2));
+            new_rule.destination = rule_str.substr(rule_str.find(':') + 1);
+            new_rule.greater = rule_str[1] == '>';
             workflow.rules.push_back(new_rule);
         } 
     }
@@ -92,55 +105,55 @@ std::unordered_map<std::string_view, Workflow> parseWorkflows(const std::string&
     return workflows;
 }
 
-std::vector<Rating> parseRatings(std::string& input){
-    std::vector<Rating> ratings;
+std::pmr::vector<Rating> parseRatings(std::string_view input, std::pmr::memory_resource* arena){
+    std::pmr::vector<Rating> ratings(arena);
     for (auto line : input | views::split('\n') | views::drop_while([](auto line){return !line.empty();}) | views::drop(1)){
         std::string_view rating(line);
+        if (rating.empty()) continue;
         rating.remove_prefix(1);
         rating.remove_suffix(1);
 
         Rating& new_rating = ratings.emplace_back();
         for (auto chunk : rating | views::split(',')){
-            new_rating.data.at(chunk.front()) = std::atoll((chunk | views::drop(2)).data());
+            new_rating[chunk.front()] = aoc::parseInteger<int64_t>(std::string_view(chunk));
         }
     }
 
     return ratings;
 }
 
-size_t processWorkflow(std::unordered_multimap<std::string, RatingRange>& result, const std::unordered_map<std::string_view, Workflow>& workflows){
+size_t processWorkflow(std::vector<std::pair<std::string_view, RatingRange>>& result, const Workflows& workflows){
 
     size_t total = 0;
-    auto storeRange = [&total, &result](const std::string& destination, const RatingRange& range){
+    auto storeRange = [&total, &result](std::string_view destination, const RatingRange& range){
         if (destination == "A"){
-            total += (range.upper.data.at(X) - range.lower.data.at(X) + 1)
-                   * (range.upper.data.at(M) - range.lower.data.at(M) + 1)
-                   * (range.upper.data.at(A) - range.lower.data.at(A) + 1)
-                   * (range.upper.data.at(S) - range.lower.data.at(S) + 1);
+            total += (range.upper[X] - range.lower[X] + 1)
+                   * (range.upper[M] - range.lower[M] + 1)
+                   * (range.upper[A] - range.lower[A] + 1)
+                   * (range.upper[S] - range.lower[S] + 1);
         }else if (destination != "R"){
-            result.insert({destination, range});
+            result.emplace_back(destination, range);
         }
     };
 
-    // Pop the fist element in the results range
-    auto it = result.begin();
-    RatingRange old_range = it->second;
-    const Workflow& workflow = workflows.at(it->first);
-    result.erase(it);
+    // Pop the last element in the results range
+    auto [label, old_range] = result.back();
+    const Workflow& workflow = workflows.at(label);
+    result.pop_back();
 
     // Run the range through its assigned workflow and split it as necessary for each rule
     for (const Rule& rule : workflow.rules){
-        int64_t& old_lower_bound = old_range.lower.data.at(rule.type);
-        int64_t& old_upper_bound = old_range.upper.data.at(rule.type);
+        int64_t& old_lower_bound = old_range.lower[rule.type];
+        int64_t& old_upper_bound = old_range.upper[rule.type];
 
         // If both ends of the range give the same result, then we don't need to split it
-        bool lower_works = std::invoke(rule.comparator, old_lower_bound, rule.limit);
-        bool upper_works = std::invoke(rule.comparator, old_upper_bound, rule.limit);
+        bool lower_works = rule.test(old_lower_bound);
+        bool upper_works = rule.test(old_upper_bound);
         if (!(lower_works ^ upper_works)) continue;
 
         RatingRange new_range = old_range;
-        int64_t& new_lower_bound = new_range.lower.data.at(rule.type);
-        int64_t& new_upper_bound = new_range.upper.data.at(rule.type);
+        int64_t& new_lower_bound = new_range.lower[rule.type];
+        int64_t& new_upper_bound = new_range.upper[rule.type];
 
         if (lower_works && !upper_works){
             old_lower_bound = rule.limit;
@@ -158,22 +171,39 @@ size_t processWorkflow(std::unordered_multimap<std::string, RatingRange>& result
     return total;
 }
 
-int main(){
-    std::string input_str = loadInput("day_19_data.txt");
-    const auto start_time = std::chrono::steady_clock::now();
+// The workflows and ratings are allocated from the arena, so it's declared first to outlive them
+struct Parsed{
+    std::unique_ptr<aoc::Arena> arena;
+    Workflows workflows;
+    std::pmr::vector<Rating> ratings;
+};
+
+Parsed parse(std::string_view input_str){
+    AOC_SCOPED_TIMER("parse");
+    auto arena = std::make_unique<aoc::Arena>();
+    Workflows workflows = parseWorkflows(input_str, arena.get());
+    std::pmr::vector<Rating> ratings = parseRatings(input_str, arena.get());
+    return Parsed{
+        .arena     = std::move(arena),
+        .workflows = std::move(workflows),
+        .ratings   = std::move(ratings)
+    };
+}
 
-    auto workflows = parseWorkflows(input_str);
-    auto ratings   = parseRatings(input_str);
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const auto& workflows = parsed.workflows;
+    const auto& ratings = parsed.ratings;
 
     // Part 1
     size_t total = 0;
     for (const Rating& rating : ratings){
-        std::string next = "in";
+        std::string_view next = "in";
         while(next != "A" & next != "R"){
-            Workflow& workflow = workflows.at(next);
+            const Workflow& workflow = workflows.at(next);
             bool path_found = false;
             for (const Rule& rule : workflow.rules){
-                if (std::invoke(rule.comparator, rating.data.at(rule.type), rule.limit)){
+                if (rule.test(rating[rule.type])){
                     next = rule.destination;
                     path_found = true;
                     break;
@@ -183,19 +213,104 @@ int main(){
         }
 
         if (next == "A"){
-            total += ranges::fold_left(rating.data | views::values, 0, std::plus{});
+            total += ranges::fold_left(rating.data, 0, std::plus{});
         }
     }
 
     // Part 2
-    std::unordered_multimap<std::string, RatingRange> all_ranges{{"in", RatingRange{}}};
+    std::vector<std::pair<std::string_view, RatingRange>> all_ranges{{"in", RatingRange{}}};
     size_t total_combos = 0;
     while (!all_ranges.empty()){
         total_combos += processWorkflow(all_ranges, workflows);
     }
 
+    return aoc::Answer{.part1 = static_cast<int64_t>(total), .part2 = static_cast<int64_t>(total_combos)};
+}
+
+// Parse cache layout: one record per workflow with its rules stored back to back, then the
+// ratings. Labels are saved as references into the input
+struct WorkflowRecord{
+    aoc::cache::TextRef label;
+    aoc::cache::TextRef final;
+    uint64_t num_rules;
+};
+
+// Records are written as raw bytes, so the padding is spelled out and zeroed to keep the
+// cache file the same for the same input
+struct RuleRecord{
+    aoc::cache::TextRef destination;
+    int64_t limit;
+    char type;
+    bool greater;
+    std::array<char, 6> padding{};
+};
+static_assert(std::has_unique_object_representations_v<RuleRecord>);
+static_assert(std::has_unique_object_representations_v<WorkflowRecord>);
+
+void save(const Parsed& parsed, std::string_view input, aoc::cache::Writer& writer){
+    std::vector<WorkflowRecord> workflow_records;
+    std::vector<RuleRecord> rule_records;
+    for (const auto& [label, workflow] : parsed.workflows){
+        workflow_records.push_back({aoc::cache::ref(input, label), aoc::cache::ref(input, workflow.final), workflow.rules.size()});
+        for (const Rule& rule : workflow.rules){
+            rule_records.push_back({aoc::cache::ref(input, rule.destination), rule.limit, rule.type, rule.greater});
+        }
+    }
+    writer.writeArray(workflow_records);
+    writer.writeArray(rule_records);
+    writer.writeArray(parsed.ratings);
+}
+
+Parsed load(aoc::cache::Reader& reader, std::string_view input){
+    auto arena = std::make_unique<aoc::Arena>();
+    const std::vector<WorkflowRecord> workflow_records = reader.readArray<WorkflowRecord>();
+    const std::vector<RuleRecord> rule_records         = reader.readArray<RuleRecord>();
+
+    Workflows workflows(arena.get());
+    workflows.reserve(workflow_records.size());
+    std::span<const RuleRecord> remaining_rules(rule_records);
+    for (const WorkflowRecord& record : workflow_records){
+        if (record.num_rules > remaining_rules.size()) throw std::runtime_error("day 19: cached rules are truncated");
+        Workflow workflow{.rules = std::pmr::vector<Rule>(arena.get()), .final = aoc::cache::deref(input, record.final)};
+        for (const RuleRecord& rule : remaining_rules.first(record.num_rules)){
+            workflow.rules.push_back(Rule{
+                .type        = static_cast<PartType>(rule.type),
+                .greater     = rule.greater,
+                .limit       = rule.limit,
+                .destination = aoc::cache::deref(input, rule.destination)
+            });
+        }
+        remaining_rules = remaining_rules.subspan(record.num_rules);
+        workflows.try_emplace(aoc::cache::deref(input, record.label), std::move(workflow));
+    }
+
+    std::pmr::vector<Rating> ratings(arena.get());
+    reader.readArray(ratings);
+    return Parsed{
+        .arena     = std::move(arena),
+        .workflows = std::move(workflows),
+        .ratings   = std::move(ratings)
+    };
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(19, parse, solve, aoc::cache::CacheIO<Parsed>{.schema_version = 1, .save = save, .load = load});
+}
+
+} // namespace day19
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input_str = mapInput(day19::filename);
+    const auto start_time = std::chrono::steady_clock::now();
+
+    day19::Parsed parsed = day19::parse(input_str);
+    aoc::Answer answer = day19::solve(parsed);
+
     const auto stop_time = std::chrono::steady_clock::now();
-    std::println("Total is {}", total);
-    std::println("Total number of combinations is {}", total_combos);
+    std::println("Total is {}", answer.part1);
+    std::println("Total number of combinations is {}", answer.part2);
     std::println("Calculations took {} microseconds", std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count());
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(19, input_str.size());
+}
+#endif
@@ -1,66 +1,266 @@
+#include <span>
+#include <array>
 #include <print>
-#include <ranges>
 #include <string>
-#include <fstream>
-#include <unordered_map>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <functional>
+#include <algorithm>
+#include <string_view>
 
-using namespace std::string_view_literals;
+#include "load_input.hpp"
+#include "line_engine.hpp"
+#include "parse_numbers.hpp"
+#include "stream_reader.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
+namespace day2{
 
 static constexpr std::string filename{"day_2_data.txt"};
 
-int main(){
-    std::ifstream text_file(filename);
-    
-    uint32_t power    = 0;
-    uint32_t passcode = 0;
-
-    for (std::string line; std::getline(text_file, line);){
-
-        // Remove the "Game " prefix
-        std::string_view line_view(line);
-        line_view.remove_prefix(5);
-
-        // Find the game index
-        size_t colon_idx = line_view.find(':');
-        const std::string_view game_idx_view = line_view.substr(0, colon_idx);
-        const int game_idx = std::atoi(std::string(game_idx_view).c_str());
-        line_view.remove_prefix(colon_idx+1);
-
-        // Extract the data
-        std::unordered_map<std::string, int> max_vals{{"red", 0}, {"blue", 0}, {"green", 0}};
-        bool possible = true;
-
-        // Split into each round based on semicolons
-        for (auto round : line_view | std::views::split(";"sv)){
-            int round_total = 0;
-
-            // Each instance in a round is separated by commas
-            for (auto instance : round | std::views::split(","sv)){
-                auto sections = instance | std::views::split(" "sv);
-
-                // Account for the space at the beginning of the instance
-                auto it = sections.begin();
-                std::string_view count_view{*++it};
-                std::string_view label_view{*++it};
-                int count = std::atoi(std::string(count_view).c_str());
-
-                // Determine the total ball count for this instance
-                round_total += count;
-                possible = possible && round_total <= (12 + 13 + 14);
-
-                // Update the max values seen
-                std::string label{label_view};
-                max_vals.at(label) = std::max(max_vals.at(label), count);
+enum Colour{
+    RED,
+    GREEN,
+    BLUE
+};
+
+// Bag limits for the passcode, in red, green, blue order
+static constexpr std::array<uint32_t, 3> bag_limits{12, 13, 14};
+
+// Most cubes of each colour shown at once in a game, in red, green, blue order
+struct GameRecord{
+    std::array<uint32_t, 3> max_counts{};
+    uint32_t id = 0;
+};
+
+// Single pass over the bytes of a "Game N: 3 blue, 4 red; ..." line. Counts are accumulated
+// digit by digit and a colour is known from its first letter, after which the rest of the
+// word is skipped. Rounds and separators need no state of their own since every game keeps
+// only the largest count of each colour
+GameRecord parseGame(std::string_view line){
+    GameRecord game;
+    const char* p   = line.data();
+    const char* end = p + line.size();
+
+    // "Game " and the id up to the colon
+    p += std::min<size_t>(5, line.size());
+    for (; p < end && *p != ':'; p++){
+        if (*p >= '0' && *p <= '9') game.id = game.id*10 + (*p - '0');
+    }
+
+    uint32_t count = 0;
+    for (; p < end; p++){
+        const char c = *p;
+        if (c >= '0' && c <= '9'){
+            count = count*10 + (c - '0');
+        }else if (c == 'r' || c == 'g' || c == 'b'){
+            uint32_t& max_count = game.max_counts[c == 'r' ? RED : c == 'g' ? GREEN : BLUE];
+            max_count = std::max(max_count, count);
+            count = 0;
+            while (p + 1 < end && p[1] >= 'a' && p[1] <= 'z') p++;
+        }
+    }
+    return game;
+}
+
+bool isPossible(const GameRecord& game){
+    return game.max_counts[RED] <= bag_limits[RED] && game.max_counts[GREEN] <= bag_limits[GREEN] && game.max_counts[BLUE] <= bag_limits[BLUE];
+}
+
+// Passcode (part 1) and power (part 2) contributed by a single game
+aoc::Answer scoreGame(const GameRecord& game){
+    return aoc::Answer{
+        .part1 = isPossible(game) ? game.id : 0,
+        .part2 = static_cast<int64_t>(game.max_counts[RED]) * game.max_counts[GREEN] * game.max_counts[BLUE]
+    };
+}
+
+// Every game's record, in input order. Parsed once, so any number of bag limits can be
+// checked against them with possibleIdSums as well as scored by solve
+struct Parsed{
+    std::vector<GameRecord> games;
+};
+
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    return Parsed{.games = aoc::LineEngine{}.mapLines(input, parseGame)};
+}
+
+namespace detail{
+
+// A game or a limits query, ordered by red so that every game before a query in the sweep
+// has at most the query's red count. For a game blue is its compressed rank, for a query
+// the number of distinct blue counts at or below its limit
+struct DominanceEvent{
+    uint32_t red = 0;
+    uint32_t green = 0;
+    uint32_t blue = 0;
+    uint32_t id = 0;
+    int32_t query = -1;  // Index of the query, or -1 for a game
+};
+
+class Fenwick{
+public:
+    explicit Fenwick(size_t size) : tree_(size + 1, 0) {}
+
+    void add(size_t pos, int64_t value){
+        for (pos++; pos < tree_.size(); pos += pos & -pos) tree_[pos] += value;
+    }
+
+    // Sum of the first count positions
+    int64_t prefix(size_t count) const {
+        int64_t total = 0;
+        for (; count > 0; count -= count & -count) total += tree_[count];
+        return total;
+    }
+
+private:
+    std::vector<int64_t> tree_;
+};
+
+// Offline divide and conquer over the red order. Once both halves are done, games in the
+// left half count towards queries in the right half wherever green and blue also fit,
+// which is a sweep over green with blue in the Fenwick tree. Each half comes back sorted
+// by green so the sweep is a merge
+inline void dominanceSums(std::span<DominanceEvent> events, Fenwick& fenwick, std::vector<int64_t>& sums, std::vector<DominanceEvent>& scratch){
+    if (events.size() < 2) return;
+    const size_t mid = events.size() / 2;
+    const std::span<DominanceEvent> left = events.first(mid), right = events.subspan(mid);
+    dominanceSums(left, fenwick, sums, scratch);
+    dominanceSums(right, fenwick, sums, scratch);
+
+    size_t added = 0;
+    for (const DominanceEvent& event : right){
+        if (event.query < 0) continue;
+        for (; added < left.size() && left[added].green <= event.green; added++){
+            if (left[added].query < 0) fenwick.add(left[added].blue, left[added].id);
+        }
+        sums[event.query] += fenwick.prefix(event.blue);
+    }
+    for (size_t idx = 0; idx < added; idx++){
+        if (left[idx].query < 0) fenwick.add(left[idx].blue, -static_cast<int64_t>(left[idx].id));
+    }
+
+    const auto by_green = [](const DominanceEvent& a, const DominanceEvent& b){return a.green < b.green;};
+    scratch.clear();
+    std::ranges::merge(left, right, std::back_inserter(scratch), by_green);
+    std::ranges::copy(scratch, events.begin());
+}
+
+} // namespace detail
+
+// Sum of the ids of the games possible under each set of bag limits, in red, green, blue
+// order. The queries are answered together in O((games + queries) log^2) rather than
+// scanning every game for each one
+std::vector<int64_t> possibleIdSums(std::span<const GameRecord> games, std::span<const std::array<uint32_t, 3>> limits){
+    AOC_SCOPED_TIMER("solve");
+    std::vector<uint32_t> blues;
+    blues.reserve(games.size());
+    for (const GameRecord& game : games) blues.push_back(game.max_counts[BLUE]);
+    std::ranges::sort(blues);
+    blues.erase(std::ranges::unique(blues).begin(), blues.end());
+
+    std::vector<detail::DominanceEvent> events;
+    events.reserve(games.size() + limits.size());
+    for (const GameRecord& game : games){
+        const uint32_t blue = std::ranges::lower_bound(blues, game.max_counts[BLUE]) - blues.begin();
+        events.push_back({.red = game.max_counts[RED], .green = game.max_counts[GREEN], .blue = blue, .id = game.id});
+    }
+    for (size_t idx = 0; idx < limits.size(); idx++){
+        const uint32_t blue = std::ranges::upper_bound(blues, limits[idx][BLUE]) - blues.begin();
+        events.push_back({.red = limits[idx][RED], .green = limits[idx][GREEN], .blue = blue, .query = static_cast<int32_t>(idx)});
+    }
+    // Games go before queries with the same red count, since those still fit
+    std::ranges::sort(events, [](const detail::DominanceEvent& a, const detail::DominanceEvent& b){
+        return a.red != b.red ? a.red < b.red : a.query < b.query;
+    });
+
+    std::vector<int64_t> sums(limits.size(), 0);
+    detail::Fenwick fenwick(blues.size());
+    std::vector<detail::DominanceEvent> scratch;
+    scratch.reserve(events.size());
+    detail::dominanceSums(events, fenwick, sums, scratch);
+    return sums;
+}
+
+// The same sums by checking every game against every set of limits, to test the index with
+std::vector<int64_t> possibleIdSumsBruteForce(std::span<const GameRecord> games, std::span<const std::array<uint32_t, 3>> limits){
+    std::vector<int64_t> sums(limits.size(), 0);
+    for (size_t idx = 0; idx < limits.size(); idx++){
+        for (const GameRecord& game : games){
+            const bool fits = game.max_counts[RED] <= limits[idx][RED] && game.max_counts[GREEN] <= limits[idx][GREEN] && game.max_counts[BLUE] <= limits[idx][BLUE];
+            if (fits) sums[idx] += game.id;
+        }
+    }
+    return sums;
+}
+
+// Bag limits written as red,green,blue, e.g. 12,13,14. Empty unless there are exactly three
+// counts and none of them is negative
+std::optional<std::array<uint32_t, 3>> parseLimits(std::string_view arg){
+    std::array<uint32_t, 4> counts{};
+    if (arg.contains('-') || aoc::parseIntegers(arg, std::span<uint32_t>(counts)) != 3) return {};
+    return std::array<uint32_t, 3>{counts[RED], counts[GREEN], counts[BLUE]};
+}
+
+// Games are scored independently, so solving is one parallel pass over the records
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    return aoc::LineEngine{}.mapReduceItems(std::span(parsed.games), scoreGame, std::plus{});
+}
+
+// Same answers as parse and solve, reading the input a block at a time so memory use stays
+// constant however large it is
+aoc::Answer solveStream(aoc::StreamReader& reader){
+    AOC_SCOPED_TIMER("solve");
+    return aoc::mapReduceStream(reader, [](std::string_view line){return scoreGame(parseGame(line));}, std::plus{});
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(2, parse, solve);
+}
+
+} // namespace day2
+
+#ifndef AOC_LIBRARY
+// With arguments, each one is a set of bag limits such as 12,13,14 and the sum of the ids
+// of the games possible with it is printed instead. --check first compares every sum with
+// a scan over all the games
+int main(int argc, char** argv){
+    if (argc > 1){
+        const bool check = std::string_view(argv[1]) == "--check";
+        std::vector<std::array<uint32_t, 3>> limits;
+        for (int idx = check ? 2 : 1; idx < argc; idx++){
+            const std::optional<std::array<uint32_t, 3>> parsed = day2::parseLimits(argv[idx]);
+            if (!parsed){
+                std::println(stderr, "Bad bag limits '{}'", argv[idx]);
+                std::println(stderr, "Usage: day2_sol [--check] [RED,GREEN,BLUE ...]");
+                return 1;
             }
-            // Keep track of whether or not the game is possible
-            possible = possible && !(max_vals["red"] > 12 || max_vals["blue"] > 14 || max_vals["green"] > 13);
+            limits.push_back(*parsed);
         }
 
-        // Increment the power and passcode
-        power += max_vals["red"]*max_vals["green"]*max_vals["blue"];
-        passcode += game_idx * possible;
+        const MappedInput input = mapInput(day2::filename);
+        const day2::Parsed parsed = day2::parse(input);
+        const std::vector<int64_t> sums = day2::possibleIdSums(parsed.games, limits);
+        if (check && sums != day2::possibleIdSumsBruteForce(parsed.games, limits)){
+            std::println(stderr, "The query index disagrees with the brute force sums");
+            return 1;
+        }
+        for (size_t idx = 0; idx < limits.size(); idx++){
+            std::println("{},{},{}: {}", limits[idx][day2::RED], limits[idx][day2::GREEN], limits[idx][day2::BLUE], sums[idx]);
+        }
+        AOC_INSTRUMENT_REPORT(2, input.view().size());
+        return 0;
     }
 
-    std::println("The passcode is {} and the power is {}", passcode, power);
+    aoc::StreamReader reader(day2::filename);
+    aoc::Answer answer = day2::solveStream(reader);
+
+    std::println("The passcode is {} and the power is {}", answer.part1, answer.part2);
+    AOC_INSTRUMENT_REPORT(2, reader.bytesRead());
     return 0;
-}
\ No newline at end of file
+}
+#endif
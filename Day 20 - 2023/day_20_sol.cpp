@@ -1,19 +1,27 @@
 #include <print>
 #include <array>
 #include <deque>
+#include <memory>
 #include <string>
 #include <ranges>
 #include <chrono>
 #include <vector>
+#include <stdexcept>
 #include <algorithm>
-#include <unordered_map>
-#include <unordered_set>
 #include "load_input.hpp"
+#include "arena.hpp"
+#include "flat_hash_map.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
 
 namespace ranges = std::ranges;
 namespace views  = std::views;
 using namespace std::string_view_literals;
 
+namespace day20{
+
+static constexpr std::string filename{"day_20_data.txt"};
+
 enum Signal {
     HIGH,
     LOW,
@@ -49,24 +57,22 @@ enum ModuleTag{
     BROADCASTER,
 };
 
+// Modules and their tables are allocated from the arena owned by Parsed
 struct Module{
-    static size_t high_pulses;
-    static size_t low_pulses;
-    std::vector<std::string_view> outputs;
+    explicit Module(std::pmr::memory_resource* arena) : outputs(arena) {}
+    virtual ~Module() = default;
+
+    std::pmr::vector<std::string_view> outputs;
     virtual Signal process(Signal signal, std::string_view source) = 0;
     virtual ModuleTag tag() const = 0;
     virtual bool isInit() const = 0;
     virtual std::vector<bool> state() const{
         return {};
     };
-    Signal recordOutput(Signal output){
-        if (output == HIGH) high_pulses += outputs.size();
-        if (output == LOW)  low_pulses  += outputs.size();
-        return output;
-    }
 };
 
 struct FlipFlop : public Module{
+    using Module::Module;
     Signal internal_state = LOW;
     ModuleTag tag() const override {return FLIPFLOP;}
     bool isInit() const override {
@@ -75,7 +81,7 @@ struct FlipFlop : public Module{
     Signal process(Signal signal, std::string_view /*source*/) override {
         if (signal == LOW) {
             internal_state = invert(internal_state);
-            return recordOutput(internal_state);
+            return internal_state;
         }
         else return NONE;
     }
@@ -85,7 +91,8 @@ struct FlipFlop : public Module{
 };
 
 struct Conjunction : public Module{
-    std::unordered_map<std::string_view, Signal> last_inputs;
+    explicit Conjunction(std::pmr::memory_resource* arena) : Module(arena), last_inputs(arena) {}
+    aoc::pmr::FlatHashMap<std::string_view, Signal> last_inputs;
     ModuleTag tag() const override {return CONJUNCTION;}
     bool isInit() const override{
         return ranges::all_of(last_inputs | views::values, [](Signal sig){return sig == LOW;});
@@ -93,9 +100,9 @@ struct Conjunction : public Module{
     Signal process(Signal signal, std::string_view source) override {
         last_inputs.at(source) = signal;
         if (ranges::all_of(last_inputs | views::values, [](Signal sig){return sig == HIGH;})){
-            return recordOutput(LOW);
+            return LOW;
         }else{
-            return recordOutput(HIGH);
+            return HIGH;
         }
     }
     std::vector<bool> state() const override {
@@ -104,18 +111,60 @@ struct Conjunction : public Module{
 };
 
 struct Broadcaster : public Module{
+    using Module::Module;
     ModuleTag tag() const override {return BROADCASTER;}
     bool isInit() const override {return true;}
     Signal process(Signal signal, std::string_view /*source*/) override {
-        return recordOutput(signal);
+        return signal;
     }
 };
 
-std::unordered_map<std::string_view, std::shared_ptr<Module>> parseInput(const std::string& input_str){
-    std::unordered_map<std::string_view, std::shared_ptr<Module>> all_modules;
-    std::unordered_set<std::string_view> conjunctions;
+using ModuleMap = aoc::pmr::FlatHashMap<std::string_view, std::shared_ptr<Module>>;
+
+template<typename T>
+std::shared_ptr<Module> makeModule(std::pmr::memory_resource* arena){
+    return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(arena), arena);
+}
+
+std::shared_ptr<Module> makeModule(ModuleTag tag, std::pmr::memory_resource* arena){
+    switch (tag){
+        case FLIPFLOP   : return makeModule<FlipFlop>(arena);
+        case CONJUNCTION: return makeModule<Conjunction>(arena);
+        case BROADCASTER: return makeModule<Broadcaster>(arena);
+    }
+    std::unreachable();
+}
+
+// Every conjunction starts out remembering a low pulse from each of its inputs
+void connectConjunctions(ModuleMap& all_modules){
+    for (auto [name, module] : all_modules){
+        for (std::string_view output : module->outputs){
+            auto target = all_modules.find(output);
+            if (target != all_modules.end() && target->second->tag() == CONJUNCTION){
+                std::static_pointer_cast<Conjunction>(target->second)->last_inputs.insert({name, LOW});
+            }
+        }
+    }
+}
+
+// Fresh copy of the modules in their initial state, for a run to push pulses through
+ModuleMap copyModules(const ModuleMap& layout, std::pmr::memory_resource* arena){
+    ModuleMap all_modules(arena);
+    all_modules.reserve(layout.size());
+    for (const auto& [name, module] : layout){
+        std::shared_ptr<Module> copy = makeModule(module->tag(), arena);
+        copy->outputs.assign(module->outputs.begin(), module->outputs.end());
+        all_modules.try_emplace(name, std::move(copy));
+    }
+    connectConjunctions(all_modules);
+    return all_modules;
+}
+
+ModuleMap parseInput(std::string_view input_str, std::pmr::memory_resource* arena){
+    ModuleMap all_modules(arena);
     for (auto line : input_str | views::split('\n')){
         std::string_view line_view(line);
+        if (line_view.empty()) continue;
         size_t first_space  = line_view.find(' ');
         size_t second_space = line_view.find(' ', first_space+1);
 
@@ -126,17 +175,16 @@ std::unordered_map<std::string_view, std::shared_ptr<Module>> parseInput(const s
         switch (type){
             case '%':
                 input_label.remove_prefix(1);
-                all_modules[input_label] = std::make_shared<FlipFlop>();
+                all_modules[input_label] = makeModule<FlipFlop>(arena);
                 break;
             
             case '&':
                 input_label.remove_prefix(1);
-                all_modules[input_label] = std::make_shared<Conjunction>();
-                conjunctions.insert(input_label);
+                all_modules[input_label] = makeModule<Conjunction>(arena);
                 break;
 
             default:
-                all_modules[input_label] = std::make_shared<Broadcaster>();
+                all_modules[input_label] = makeModule<Broadcaster>(arena);
                 break;
         }
 
@@ -145,43 +193,56 @@ std::unordered_map<std::string_view, std::shared_ptr<Module>> parseInput(const s
         }
     }
 
-    for (auto [name, module] : all_modules){
-        for (std::string_view output : module->outputs){
-            if (conjunctions.contains(output)){
-                std::dynamic_pointer_cast<Conjunction>(all_modules.at(output))->last_inputs.insert({name, LOW});
-            }
-        }
-    }
-
+    connectConjunctions(all_modules);
     return all_modules;
 }
 
-size_t Module::high_pulses = 0;
-size_t Module::low_pulses  = 0;
+// Module that part 2 watches for a high pulse from. Done manually because I didn't want to fully automate this
+static constexpr std::string source_of_interest = "ln"; // "xp", "gp", "xl"
 
-int main(){
-    std::string input_str = loadInput("day_20_data.txt");
-    auto start_time = std::chrono::steady_clock::now();
+// The arena is declared first so it outlives the modules allocated from it. These modules
+// are never run, solve() works on its own copy so one Parsed can be solved any number of times
+struct Parsed{
+    std::unique_ptr<aoc::Arena> arena;
+    ModuleMap all_modules;
+};
 
+Parsed parse(std::string_view input_str){
+    AOC_SCOPED_TIMER("parse");
+    auto arena = std::make_unique<aoc::Arena>();
+    ModuleMap all_modules = parseInput(input_str, arena.get());
+    return Parsed{.arena = std::move(arena), .all_modules = std::move(all_modules)};
+}
+
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    aoc::Arena arena;
+    ModuleMap all_modules = copyModules(parsed.all_modules, &arena);
     std::deque<SignalQueueType> signal_queue;
-    std::unordered_map<std::string_view, std::shared_ptr<Module>> all_modules = parseInput(input_str);
+    size_t high_pulses = 0;
+    size_t low_pulses  = 0;
 
-    auto pressButton = [&all_modules, &signal_queue](std::string source_of_interest = "", Signal signal_of_interest = NONE) -> bool {
+    auto pressButton = [&](std::string_view source_of_interest = "", Signal signal_of_interest = NONE) -> bool {
         bool signal_of_interest_detected = false;
         
         // Push the button
-        Module::low_pulses++; 
+        low_pulses++; 
+        AOC_COUNT("button_presses", 1);
         signal_queue.push_back({.source="button", .target="broadcaster", .signal=LOW});
         while (!signal_queue.empty()){
             SignalQueueType signal_package = signal_queue.front();
             signal_queue.pop_front();
+            AOC_COUNT("pulses_processed", 1);
             signal_of_interest_detected = signal_of_interest_detected || 
                 (signal_package.source == source_of_interest && signal_package.signal == signal_of_interest);
 
-            if (!all_modules.contains(signal_package.target)) continue;
+            auto target = all_modules.find(signal_package.target);
+            if (target == all_modules.end()) continue;
 
-            Module& target_module = *all_modules.at(signal_package.target);
+            Module& target_module = *target->second;
             Signal output_signal  = target_module.process(signal_package.signal, signal_package.source);
+            if (output_signal == HIGH) high_pulses += target_module.outputs.size();
+            if (output_signal == LOW)  low_pulses  += target_module.outputs.size();
             if (output_signal != NONE) {
                 for (std::string_view output_label : target_module.outputs){
                     signal_queue.push_back({signal_package.target, output_label, output_signal});
@@ -191,22 +252,82 @@ int main(){
         return signal_of_interest_detected;
     };
 
+    size_t button_press_count = 0;
     constexpr bool part1 = false;
     if constexpr (part1){
         for (auto _ : views::iota(0, 1000)){
             pressButton();
         }
     }else{
-        // Done manually because I didn't want to fully automate this
-        std::string source_of_interest = "ln"; // "xp", "gp", "xl"
         Signal signal_of_interest = HIGH; 
-        size_t button_press_count = 1;
+        button_press_count = 1;
         for (; !pressButton(source_of_interest, signal_of_interest); button_press_count++)
             ;
-        std::println("{} cycles every {} button presses", source_of_interest, button_press_count);
     }
 
+    return aoc::Answer{
+        .part1 = static_cast<int64_t>(low_pulses*high_pulses),
+        .part2 = static_cast<int64_t>(button_press_count)
+    };
+}
+
+// Parse cache layout: one record per module with its outputs stored back to back. Labels are
+// saved as references into the input and the conjunction inputs are rebuilt on load
+struct ModuleRecord{
+    aoc::cache::TextRef name;
+    uint32_t tag;
+    uint32_t num_outputs;
+};
+
+void save(const Parsed& parsed, std::string_view input, aoc::cache::Writer& writer){
+    std::vector<ModuleRecord> module_records;
+    std::vector<aoc::cache::TextRef> outputs;
+    for (const auto& [name, module] : parsed.all_modules){
+        module_records.push_back({aoc::cache::ref(input, name), static_cast<uint32_t>(module->tag()), static_cast<uint32_t>(module->outputs.size())});
+        for (std::string_view output : module->outputs) outputs.push_back(aoc::cache::ref(input, output));
+    }
+    writer.writeArray(module_records);
+    writer.writeArray(outputs);
+}
+
+Parsed load(aoc::cache::Reader& reader, std::string_view input){
+    auto arena = std::make_unique<aoc::Arena>();
+    const std::vector<ModuleRecord> module_records  = reader.readArray<ModuleRecord>();
+    const std::vector<aoc::cache::TextRef> outputs = reader.readArray<aoc::cache::TextRef>();
+
+    ModuleMap all_modules(arena.get());
+    std::span<const aoc::cache::TextRef> remaining_outputs(outputs);
+    for (const ModuleRecord& record : module_records){
+        if (record.tag > BROADCASTER || record.num_outputs > remaining_outputs.size()) throw std::runtime_error("day 20: corrupt cached module");
+        std::shared_ptr<Module> module = makeModule(static_cast<ModuleTag>(record.tag), arena.get());
+        for (aoc::cache::TextRef output : remaining_outputs.first(record.num_outputs)){
+            module->outputs.push_back(aoc::cache::deref(input, output));
+        }
+        remaining_outputs = remaining_outputs.subspan(record.num_outputs);
+        all_modules.try_emplace(aoc::cache::deref(input, record.name), std::move(module));
+    }
+    connectConjunctions(all_modules);
+    return Parsed{.arena = std::move(arena), .all_modules = std::move(all_modules)};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(20, parse, solve, aoc::cache::CacheIO<Parsed>{.schema_version = 1, .save = save, .load = load});
+}
+
+} // namespace day20
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input_str = mapInput(day20::filename);
+    auto start_time = std::chrono::steady_clock::now();
+
+    day20::Parsed parsed = day20::parse(input_str);
+    aoc::Answer answer = day20::solve(parsed);
+
     auto stop_time = std::chrono::steady_clock::now();
-    std::println("There were {} low signals and {} high signals for a total of {}", Module::low_pulses, Module::high_pulses, Module::low_pulses*Module::high_pulses);
+    if (answer.part2 != 0) std::println("{} cycles every {} button presses", day20::source_of_interest, answer.part2);
+    std::println("The low and high signal counts multiply to {}", answer.part1);
     std::println("Calculations took {} microseconds", std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count());
+    AOC_INSTRUMENT_REPORT(20, input_str.size());
 }
+#endif
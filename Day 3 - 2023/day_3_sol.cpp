@@ -1,108 +1,366 @@
+#include <bit>
+#include <span>
+#include <array>
 #include <print>
 #include <string>
-#include <fstream>
 #include <ranges>
-#include <iostream>
-#include <sstream>
-#include <numeric>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <algorithm>
+#include <string_view>
 
-static size_t str_pos{};
+#include "load_input.hpp"
+#include "line_engine.hpp"
+#include "parse_numbers.hpp"
+#include "stream_reader.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
+namespace day3{
+
+static constexpr std::string filename{"day_3_data.txt"};
 
 // Digit filter
 bool isDigit(char c){
     return c >= '0' && c <= '9';
 };
 
-// Given that an index is a digit, collect all digits on either side into 
-// a string view and convert them to the corresponding numeric value
-int expandDigits(std::ptrdiff_t index, std::string_view str){
-    // Search to the left
-    size_t idx1 = str.substr(0, index).find_last_not_of("0123456789");
-    if (idx1 == std::string_view::npos) idx1 = 0;
-    else idx1++;
-
-    // Search to the right
-    size_t idx2 = str.substr(index).find_first_not_of("0123456789");
-    if (idx2 == std::string_view::npos) idx2 = index+1;
-    else idx2 += index;
-
-    std::string_view digits_view = str.substr(idx1, idx2 - idx1);
-    return std::atoi(digits_view.data());
+// Anything other than a digit or a period counts as a symbol
+bool isSymbol(char c){
+    return !isDigit(c) && c != '.' && c != '\n' && c != '\r';
+}
+
+// A number in the schematic, taking up columns [col_begin, col_end) of its row
+struct PartNumber{
+    uint32_t row = 0;
+    uint32_t col_begin = 0;
+    uint32_t col_end = 0;
+    uint64_t value = 0;
+};
+
+struct Labels{
+    std::string_view input;
+    size_t width  = 0;  // Columns in the longest row, not counting the newline
+    size_t height = 0;
+    std::vector<PartNumber> numbers;
+
+    // Id of the number covering each cell, 1 + its index in numbers, or 0 for none. There is
+    // a border of empty cells all round, so every cell's neighbours can be read unchecked
+    std::vector<uint32_t> labels;
+
+    size_t label(size_t row, size_t col) const {return (row + 1)*(width + 2) + col + 1;}
+};
+
+// Every number is read once into the numbers table and its cells labelled with its id.
+// Symbols then find the numbers around them by id instead of re-reading the digits
+Labels parseLabels(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    Labels parsed{.input = input};
+    if (input.ends_with('\n')) input.remove_suffix(1);
+    if (input.empty()) return parsed;
+    for (auto line_range : input | std::views::split('\n')){
+        parsed.width = std::max(parsed.width, std::string_view(line_range).size());
+        parsed.height++;
+    }
+    parsed.labels.assign((parsed.height + 2)*(parsed.width + 2), 0);
+
+    uint32_t row = 0;
+    for (auto line_range : input | std::views::split('\n')){
+        const std::string_view line(line_range);
+        const size_t cols = line.size();
+        for (size_t col = 0; col < cols; col++){
+            if (!isDigit(line[col])) continue;
+            PartNumber number{.row = row, .col_begin = static_cast<uint32_t>(col)};
+            for (; col < cols && isDigit(line[col]); col++) number.value = number.value*10 + (line[col] - '0');
+            number.col_end = static_cast<uint32_t>(col);
+
+            parsed.numbers.push_back(number);
+            const uint32_t id = parsed.numbers.size();
+            std::fill_n(parsed.labels.begin() + parsed.label(row, number.col_begin), number.col_end - number.col_begin, id);
+        }
+        row++;
+    }
+    return parsed;
+}
+
+aoc::Answer solveLabels(const Labels& parsed){
+    AOC_SCOPED_TIMER("solve");
+    std::vector<uint8_t> is_part(parsed.numbers.size(), 0);
+    int64_t gear_ratio = 0;
+
+    size_t row = 0;
+    for (auto line_range : parsed.input | std::views::split('\n')){
+        const std::string_view line(line_range);
+        for (size_t col = 0; col < line.size(); col++){
+            if (!isSymbol(line[col])) continue;
+
+            // Distinct numbers among the eight neighbours. A number covers at most three
+            // cells of a row next to the symbol, so there are never more than six
+            std::array<uint32_t, 8> ids{};
+            size_t count = 0;
+            const size_t stride = parsed.width + 2;
+            const size_t centre = parsed.label(row, col);
+            for (size_t left : {centre - stride - 1, centre - 1, centre + stride - 1}){
+                for (size_t offset = 0; offset < 3; offset++){
+                    const uint32_t id = parsed.labels[left + offset];
+                    if (id != 0 && std::find(ids.begin(), ids.begin() + count, id) == ids.begin() + count) ids[count++] = id;
+                }
+            }
+
+            for (size_t idx = 0; idx < count; idx++) is_part[ids[idx] - 1] = 1;
+            if (line[col] == '*' && count == 2){
+                gear_ratio += static_cast<int64_t>(parsed.numbers[ids[0] - 1].value) * parsed.numbers[ids[1] - 1].value;
+            }
+        }
+        if (++row == parsed.height) break;
+    }
+
+    // Each part number counts once, however many symbols it touches
+    int64_t total_sum = 0;
+    for (size_t idx = 0; idx < parsed.numbers.size(); idx++){
+        if (is_part[idx]) total_sum += parsed.numbers[idx].value;
+    }
+    return aoc::Answer{.part1 = total_sum, .part2 = gear_ratio};
+}
+
+// Bit masks of one row for the adjacency kernel, bit col % 64 of word col / 64. Each row
+// has as many words as its own length needs, and columns past its end read as clear, as
+// if the schematic were padded with periods
+struct RowMasks{
+    std::string_view text;
+    std::vector<uint64_t> digits;
+    std::vector<uint64_t> symbols;
+    std::vector<uint64_t> gears;
+};
+
+// Classify a row 64 bytes at a time with the vector compares from parse_numbers.hpp. An
+// empty line gives the all clear row used above the first and below the last
+void buildMasks(std::string_view line, RowMasks& row){
+    const size_t words = (line.size() + 63) / 64;
+    row.text = line;
+    row.digits.assign(words, 0);
+    row.symbols.assign(words, 0);
+    row.gears.assign(words, 0);
+    for (size_t word = 0; word*64 < line.size(); word++){
+        const char* p   = line.data() + word*64;
+        const size_t n  = std::min<size_t>(64, line.size() - word*64);
+        const uint64_t valid  = n == 64 ? ~0ull : (1ull << n) - 1;
+        const uint64_t digits = aoc::detail::digitMask64(p, n);
+        const uint64_t blanks = aoc::detail::byteMask64(p, n, '.') | aoc::detail::byteMask64(p, n, '\r');
+        row.digits[word]  = digits;
+        row.symbols[word] = valid & ~digits & ~blanks;
+        row.gears[word]   = aoc::detail::byteMask64(p, n, '*');
+    }
 }
 
-// Given an index in a string, get either 1 or 2 numbers from that index or to its sides
-std::pair<int, int> getNumsFromString(std::ptrdiff_t index, std::string_view str){
-    std::pair<int, int> ret_val{0, 0};
-    size_t left_idx  = std::max(index-1, std::ptrdiff_t(0));
-    size_t right_idx = std::min(index+1, std::ptrdiff_t(str.size()-1));
+// Word idx of a mask, clear past the end of its row
+uint64_t wordAt(std::span<const uint64_t> mask, size_t idx){
+    return idx < mask.size() ? mask[idx] : 0;
+}
+
+bool testBit(std::span<const uint64_t> mask, size_t col){
+    return col / 64 < mask.size() && (mask[col / 64] >> (col % 64) & 1);
+}
 
-    if (isDigit(str[index])){
-        ret_val.first = expandDigits(index, str);
-    }else{
-        if (isDigit(str[left_idx ])) ret_val.first  = expandDigits(left_idx, str);
-        if (isDigit(str[right_idx])) ret_val.second = expandDigits(right_idx, str);
+// First column at or after col whose bit is set (or clear), or the mask's width if none
+size_t findBit(std::span<const uint64_t> mask, size_t col, bool set){
+    for (size_t word = col / 64; word < mask.size(); word++){
+        uint64_t bits = set ? mask[word] : ~mask[word];
+        if (word == col / 64) bits &= ~0ull << (col % 64);
+        if (bits != 0) return word*64 + std::countr_zero(bits);
     }
-    return ret_val;
+    return mask.size()*64;
+}
+
+// First column of the run of set bits that contains col, whose bit must be set
+size_t runStart(std::span<const uint64_t> mask, size_t col){
+    for (size_t word = col / 64 + 1; word-- > 0;){
+        uint64_t clear = ~mask[word];
+        if (word == col / 64) clear &= ~0ull >> (63 - col % 64);
+        if (clear != 0) return word*64 + 64 - std::countl_zero(clear);
+    }
+    return 0;
 }
 
-int main(){
-    uint32_t total_sum = 0;
-    uint64_t gear_ratio = 0;
-
-    // Load the data into memory
-    std::ifstream text_file("day_3_data.txt");
-
-    // Append a row of periods to the beginning and end of the data
-    std::string line_of_periods;
-    if (std::getline(text_file, line_of_periods) ){
-        std::memset(line_of_periods.data(), '.', line_of_periods.size());
-        text_file.clear();
-        text_file.seekg(std::ios::beg);
-    }
-    const size_t line_len = line_of_periods.size();
-
-    std::stringstream data;
-    data << line_of_periods << '\n';
-    data << text_file.rdbuf();
-    data << '\n' << line_of_periods;
-    std::string data_str = data.str();
-
-    // Iterate through the lines three at a time
-    size_t line_idx = 0;
-    for (auto lines : std::string_view(data_str) | std::views::split('\n') | std::views::slide(3)){
-        auto line_iterator = lines.begin();
-        std::string_view line1(*line_iterator++);
-        std::string_view line2(*line_iterator++);
-        std::string_view line3(*line_iterator++);
-
-        // Look for special characters in the second line
-        auto special_chars_indices = line2 
-            | std::views::enumerate
-            | std::views::filter([](auto val){char c = std::get<1>(val); return !isDigit(c) && (c != '.');})
-            | std::views::keys;
-
-        // For each special character, examine the surrounding areas
-        for (auto idx : special_chars_indices){
-            // Get the numbers from all three lines
-            auto [line1_1, line1_2] = getNumsFromString(idx, line1);
-            auto [line2_1, line2_2] = getNumsFromString(idx, line2);
-            auto [line3_1, line3_2] = getNumsFromString(idx, line3);
-
-            std::array<int, 6> nums{line1_1, line1_2, line2_1, line2_2, line3_1, line3_2};
-            total_sum += std::reduce(nums.begin(), nums.end());
-
-            // Check if this was a gear character
-            if (line2[idx] != '*') continue;
-
-            // If it had exactly 2 characters, add on their product to the gear ratio
-            auto vals = nums | std::views::filter([](int i){return i != 0;}); 
-            if (std::ranges::distance(vals) == 2){
-                gear_ratio += std::reduce(std::begin(vals), std::end(vals), 1, std::multiplies{});
+// Value of the number covering col, which must be a digit
+uint64_t numberAt(const RowMasks& row, size_t col){
+    const size_t begin = runStart(row.digits, col);
+    const size_t end   = findBit(row.digits, col, false);
+    return aoc::detail::parseDigitRun(row.text.data() + begin, end - begin, row.text.data() + row.text.size());
+}
+
+// Part numbers and gear ratios of the middle row. The symbols of all three rows are
+// dilated by a column each way and ANDed with the row's digits, then the hits are flooded
+// along the digits to the ends of their numbers. Gears count the numbers around them from the
+// digit bits of the three rows and only read the values when there are exactly two
+aoc::Answer scoreRow(const RowMasks& above, const RowMasks& row, const RowMasks& below, std::vector<uint64_t>& parts){
+    // The rows can differ in length, and only the middle row's columns can hold parts
+    const size_t words = row.digits.size();
+    auto nearSymbols = [&](size_t idx){
+        return wordAt(above.symbols, idx) | wordAt(row.symbols, idx) | wordAt(below.symbols, idx);
+    };
+    parts.resize(words);
+    uint64_t previous = 0;
+    uint64_t current  = nearSymbols(0);
+    for (size_t idx = 0; idx < words; idx++){
+        const uint64_t next    = nearSymbols(idx + 1);
+        const uint64_t dilated = current | (current << 1) | (previous >> 63) | (current >> 1) | (next << 63);
+        parts[idx] = row.digits[idx] & dilated;
+        previous = current;
+        current  = next;
+    }
+    // Fill each hit up to the end of its number in one add: a seed bit added to the digits
+    // carries through the rest of its run, so the bits the add changed are the run from its
+    // lowest seed up. A carry out of the top of a word carries on into the next word only
+    // if the run does. The part of a number below its lowest seed is found by a bit scan
+    // when its value is read
+    uint64_t carry = 0;
+    for (size_t idx = 0; idx < words; idx++){
+        const uint64_t digits = row.digits[idx];
+        const uint64_t seeds  = parts[idx] | (carry & digits);
+        uint64_t sum;
+        carry = __builtin_add_overflow(digits, seeds, &sum) ? 1 : 0;
+        parts[idx] = (((sum ^ digits) & digits) | seeds);
+    }
+
+    aoc::Answer answer;
+    const char* const end = row.text.data() + row.text.size();
+    for (size_t col = findBit(parts, 0, true); col < words*64; col = findBit(parts, col, true)){
+        const size_t number_begin = runStart(row.digits, col);
+        const size_t number_end   = findBit(parts, col, false);
+        answer.part1 += aoc::detail::parseDigitRun(row.text.data() + number_begin, number_end - number_begin, end);
+        col = number_end;
+    }
+
+    for (size_t col = findBit(row.gears, 0, true); col < words*64; col = findBit(row.gears, col + 1, true)){
+        std::array<uint64_t, 2> values{};
+        size_t count = 0;
+        for (const RowMasks* neighbours : {&above, &row, &below}){
+            // A digit straight above or below is one number, otherwise each side may have one
+            if (testBit(neighbours->digits, col)){
+                if (count < 2) values[count] = numberAt(*neighbours, col);
+                count++;
+                continue;
+            }
+            // col - 1 wraps around at the left edge, where testBit is always false
+            for (size_t side : {col - 1, col + 1}){
+                if (!testBit(neighbours->digits, side)) continue;
+                if (count < 2) values[count] = numberAt(*neighbours, side);
+                count++;
             }
         }
-        line_idx++;
+        if (count == 2) answer.part2 += static_cast<int64_t>(values[0] * values[1]);
+    }
+    return answer;
+}
+
+// The last three rows seen, in a ring. Each row is copied into its slot, so the buffer it
+// came from can be reused as soon as it has been pushed, and memory stays at a few times
+// the row width however many rows there are
+class RowWindow{
+public:
+    // Add the next row. Returns the parts and gears of the row before it, which now has
+    // both its neighbours
+    aoc::Answer push(std::string_view line){
+        if (rows_++ == 0) buildMasks({}, masks_[newest_]);
+        advance(line);
+        return rows_ < 2 ? aoc::Answer{} : scoreNewest();
+    }
+
+    // Score the last row against an empty row below it
+    aoc::Answer finish(){
+        if (rows_ == 0) return {};
+        advance({});
+        return scoreNewest();
+    }
+
+private:
+    void advance(std::string_view line){
+        newest_ = (newest_ + 1) % 3;
+        text_[newest_].assign(line);
+        buildMasks(text_[newest_], masks_[newest_]);
+    }
+
+    aoc::Answer scoreNewest(){
+        return scoreRow(masks_[(newest_ + 1) % 3], masks_[(newest_ + 2) % 3], masks_[newest_], parts_);
+    }
+
+    std::array<std::string, 3> text_;
+    std::array<RowMasks, 3> masks_;
+    std::vector<uint64_t> parts_;
+    size_t newest_ = 0;
+    size_t rows_   = 0;
+};
+
+struct Parsed{
+    std::vector<RowMasks> rows;
+};
+
+// Rows are classified into their masks in parallel. The masks point into the input
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    return Parsed{.rows = aoc::LineEngine{}.mapLines(input, [](std::string_view line){
+        RowMasks row;
+        buildMasks(line, row);
+        return row;
+    })};
+}
+
+// Each row only needs its neighbours' masks, so the rows are scored in parallel
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const RowMasks empty_row;
+    return aoc::LineEngine{}.mapReduceItems(std::span(parsed.rows), [&](const RowMasks& row){
+        thread_local std::vector<uint64_t> parts;
+        const size_t idx = &row - parsed.rows.data();
+        const RowMasks& above = idx > 0 ? parsed.rows[idx - 1] : empty_row;
+        const RowMasks& below = idx + 1 < parsed.rows.size() ? parsed.rows[idx + 1] : empty_row;
+        return scoreRow(above, row, below, parts);
+    }, std::plus{}, 64);
+}
+
+// Same answers as parse and solve, reading the input a block at a time. Only the stream's two
+// buffers and the three rows of the window are ever held, so the schematic can be far
+// larger than memory
+aoc::Answer solveStream(aoc::StreamReader& reader){
+    AOC_SCOPED_TIMER("solve");
+    RowWindow window;
+    aoc::Answer answer;
+    for (std::string_view block; !(block = reader.next()).empty();){
+        for (auto line : block | std::views::split('\n')){
+            if (!line.empty()) answer = answer + window.push(std::string_view(line));
+        }
     }
-    std::println("The total sum is {}", total_sum);
-    std::println("The total gear ratio is {}", gear_ratio);
+    return answer + window.finish();
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(3, parse, solve);
+}
+
+} // namespace day3
+
+#ifndef AOC_LIBRARY
+// With --labels the schematic is solved through the number label buffer instead of
+// being streamed through the row masks
+int main(int argc, char** argv){
+    if (argc > 1 && std::string_view(argv[1]) == "--labels"){
+        MappedInput input = mapInput(day3::filename);
+        aoc::Answer answer = day3::solveLabels(day3::parseLabels(input));
+
+        std::println("The total sum is {}", answer.part1);
+        std::println("The total gear ratio is {}", answer.part2);
+        AOC_INSTRUMENT_REPORT(3, input.size());
+        return 0;
+    }
+
+    aoc::StreamReader reader(day3::filename);
+    aoc::Answer answer = day3::solveStream(reader);
+
+    std::println("The total sum is {}", answer.part1);
+    std::println("The total gear ratio is {}", answer.part2);
+    AOC_INSTRUMENT_REPORT(3, reader.bytesRead());
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -1,21 +1,36 @@
 #include <print>
 #include <ranges>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <vector>
+#include <span>
+#include <deque>
+#include <cstdint>
+#include <algorithm>
 #include <unordered_set>
 
+#include "load_input.hpp"
+#include "arena.hpp"
+#include "line_engine.hpp"
+#include "stream_reader.hpp"
+#include "parse_numbers.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
 using namespace std::string_literals;
 
-uint32_t collectCopies(size_t card_idx, const std::vector<int>& match_counts, std::vector<int>& copies_collected){
+namespace day4{
+
+static constexpr std::string filename{"day_4_data.txt"};
+
+int64_t collectCopies(size_t card_idx, const std::vector<int>& match_counts, std::vector<int64_t>& copies_collected){
     const int num_matches = match_counts[card_idx];
-    int& copy_count = copies_collected[card_idx];
+    int64_t& copy_count = copies_collected[card_idx];
 
     // Cache results
     if (copy_count >= 0){return copy_count;}
 
     // This card collects copies as long as there are enough cards after it
-    copy_count = std::min(num_matches, static_cast<int>(match_counts.size() - card_idx - 1));
+    copy_count = std::min<int64_t>(num_matches, match_counts.size() - card_idx - 1);
 
     // If not cached, recursively score cards
     size_t max_card_idx = card_idx + copy_count + 1;
@@ -25,61 +40,107 @@ uint32_t collectCopies(size_t card_idx, const std::vector<int>& match_counts, st
     return copy_count;
 }
 
-int main(){
-    // Convert input to a vector of lines
-    std::ifstream text_file{"day_4_data.txt"};
-    std::vector<std::string> cards(1);
-    while (std::getline(text_file, cards.back())){
-        cards.push_back({});
-    }
-    cards.pop_back();
-
-    uint32_t total_score = 0;
-    std::vector<int> card_match_counts(cards.size(), 0);
-    for (auto [line_idx, line] : cards | std::views::enumerate){
-        std::string_view line_view(line);
-
-        // Remove the card number
-        size_t delim = line_view.find(':');
-        line_view.remove_prefix(delim+2);
-
-        // Split by the vertical line
-        auto sets = line_view | std::views::split(" | "s);
-        std::string_view winning_nums{*sets.begin()};
-        std::string_view our_numbers{*(std::ranges::next(sets.begin()))};
-
-        // Create sets for both groups of numbers
-        std::unordered_set<int> winning_set;
-        for (auto string_num : winning_nums | std::views::split(' ')){
-            if (string_num.front() == ' ') continue;
-            winning_set.insert(std::atoi(string_num.data()));
-        }
-        std::unordered_set<int> our_num_set;
-        for (auto string_num : our_numbers | std::views::split(' ')){
-            if (string_num.front() == ' ') continue;
-            our_num_set.insert(std::atoi(string_num.data()));
-        }
+// Number of our numbers on a card that are also winning numbers
+int countMatches(std::string_view line_view){
+    // Remove the card number
+    size_t delim = line_view.find(':');
+    line_view.remove_prefix(delim+2);
 
-        // Determine the overlap
-        uint16_t score = 0x0001;
-        for (int val : winning_set){
-            if (our_num_set.contains(val)) {
-                score <<= 1;
-                card_match_counts[line_idx]++;
-            }
-        }
+    // Split by the vertical line
+    auto sets = line_view | std::views::split(" | "s);
+    std::string_view winning_nums{*sets.begin()};
+    std::string_view our_numbers{*(std::ranges::next(sets.begin()))};
+
+    // Create sets for both groups of numbers in scratch space on the stack
+    aoc::StackArena<4096> scratch;
+    std::pmr::vector<int> nums(line_view.size()/2 + 1, &scratch);
+    const size_t winning_count = aoc::parseIntegers(winning_nums, std::span(nums));
+    std::pmr::unordered_set<int> winning_set(nums.begin(), nums.begin() + winning_count, winning_count, &scratch);
+
+    const size_t our_count = aoc::parseIntegers(our_numbers, std::span(nums));
+    std::pmr::unordered_set<int> our_num_set(nums.begin(), nums.begin() + our_count, our_count, &scratch);
+
+    // Determine the overlap
+    return static_cast<int>(std::ranges::count_if(winning_set, [&](int val){return our_num_set.contains(val);}));
+}
+
+// One point for the first match, doubled for each match after it. Generated cards can have
+// any number of matches, so the doubling stops at the largest power of two an int64_t holds
+int64_t cardScore(int num_matches){
+    return num_matches <= 0 ? 0 : int64_t{1} << std::min(num_matches - 1, 62);
+}
+
+struct Parsed{
+    std::vector<int> match_counts;
+};
+
+// Cards are matched independently, so they are spread over the thread pool
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    return Parsed{.match_counts = aoc::LineEngine{}.mapLines(input, countMatches)};
+}
+
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const std::vector<int>& card_match_counts = parsed.match_counts;
 
-        // Add on the score we got
-        total_score += score >> 1;
+    // Each match doubles the score of a card
+    int64_t total_score = 0;
+    for (int num_matches : card_match_counts){
+        total_score += cardScore(num_matches);
     }
-    std::println("Total score was {}", total_score);
 
     // Loop through again and count how many cards we collect
-    uint32_t cards_collected = cards.size();
-    std::vector<int> copy_collection_counts(cards.size(), -1);
-    for (size_t card_idx = 0; card_idx < cards.size(); card_idx++){
+    int64_t cards_collected = card_match_counts.size();
+    std::vector<int64_t> copy_collection_counts(card_match_counts.size(), -1);
+    for (size_t card_idx = 0; card_idx < card_match_counts.size(); card_idx++){
         cards_collected += collectCopies(card_idx, card_match_counts, copy_collection_counts);
     }
 
-    std::println("Total collected cards was {}", cards_collected);
-}
\ No newline at end of file
+    return aoc::Answer{.part1 = total_score, .part2 = cards_collected};
+}
+
+// Same answers as parse and solve, reading the input a block at a time so memory use stays
+// constant however large it is. Copies won by a card only reach the next few cards, so
+// counting forwards only needs the copy counts of those cards
+aoc::Answer solveStream(aoc::StreamReader& reader){
+    AOC_SCOPED_TIMER("solve");
+    const aoc::LineEngine engine;
+    int64_t total_score = 0;
+    int64_t cards_collected = 0;
+    std::deque<int64_t> won_copies;
+    for (std::string_view block; !(block = reader.next()).empty();){
+        for (int num_matches : engine.mapLines(block, countMatches)){
+            total_score += cardScore(num_matches);
+
+            // This card plus every copy of it won by the cards before
+            int64_t instances = 1;
+            if (!won_copies.empty()){
+                instances += won_copies.front();
+                won_copies.pop_front();
+            }
+            cards_collected += instances;
+
+            if (won_copies.size() < static_cast<size_t>(num_matches)) won_copies.resize(num_matches, 0);
+            for (int idx = 0; idx < num_matches; idx++) won_copies[idx] += instances;
+        }
+    }
+    return aoc::Answer{.part1 = total_score, .part2 = cards_collected};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(4, parse, solve);
+}
+
+} // namespace day4
+
+#ifndef AOC_LIBRARY
+int main(){
+    aoc::StreamReader reader(day4::filename);
+    aoc::Answer answer = day4::solveStream(reader);
+
+    std::println("Total score was {}", answer.part1);
+    std::println("Total collected cards was {}", answer.part2);
+    AOC_INSTRUMENT_REPORT(4, reader.bytesRead());
+}
+#endif
@@ -5,12 +5,21 @@
 #include <string>
 #include <ranges>
 #include <vector>
-#include <thread>
-#include <fstream>
-#include <iostream>
+#include <span>
 #include <optional>
 #include <algorithm>
 
+#include "load_input.hpp"
+#include "line_engine.hpp"
+#include "parse_numbers.hpp"
+#include "log.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
+namespace day5{
+
+static constexpr std::string filename{"day_5_data.txt"};
+
 struct RangeMap{
     const int64_t dest_start;
     const int64_t source_start;
@@ -39,45 +48,70 @@ int64_t mapToNext(int64_t val, const std::vector<RangeMap>& range_maps){
     return val;
 }
 
-int main(){
-    std::ifstream text_file{"day_5_data.txt"};
-    std::string seeds_str;
-    std::getline(text_file, seeds_str);
-    
+struct Parsed{
+    std::vector<int64_t> seeds;
+    std::array<std::vector<RangeMap>, 7> map_groups;
+};
+
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    Parsed parsed;
+    auto lines = input | std::views::split('\n') | std::views::transform([](auto line){return std::string_view(line);});
+    auto line_it = lines.begin();
+    if (line_it == lines.end()) return parsed;
+
     // Process the first line to get a vector of ints of the seeds
-    auto seeds = seeds_str 
-        | std::views::drop_while([](char c){return c < '0' || c > '9';})
-        | std::views::split(' ')
-        | std::views::transform([](auto digits_view){return std::atoll(digits_view.data());})
-        | std::ranges::to<std::vector<int64_t>>();
-    
+    std::string_view seed_line = *line_it;
+    parsed.seeds.resize(seed_line.size()/2 + 1);
+    parsed.seeds.resize(aoc::parseIntegers(seed_line, std::span(parsed.seeds)));
+
     // Remove the next two useless lines
-    text_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-    text_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    std::ranges::advance(line_it, 3, lines.end());
 
     // Parse the mapping logic
     size_t group_idx = 0;
-    std::array<std::vector<RangeMap>, 7> map_groups;
-    for (std::string line; std::getline(text_file, line); ){
+    for (; line_it != lines.end(); ++line_it){
+        std::string_view line = *line_it;
+
         // If we're moving from one group to the next, take care of the useless lines
         if (line.empty()) {
             group_idx++;
-            text_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            if (++line_it == lines.end()) break;
             continue;
         }
 
         // Extract the individual values from the line and create the corresponding RangeMap
-        auto vals = line 
-            | std::views::split(' ')
-            | std::views::transform([](auto digits_view){return std::atoll(digits_view.data());});
-        auto vals_it = vals.begin();
-        map_groups[group_idx].emplace_back(RangeMap{
-            .dest_start   = *vals_it++, 
-            .source_start = *vals_it++, 
-            .dist         = *vals_it++
+        std::array<int64_t, 3> vals{};
+        aoc::parseIntegers(line, std::span<int64_t>(vals));
+        parsed.map_groups[group_idx].emplace_back(RangeMap{
+            .dest_start   = vals[0],
+            .source_start = vals[1],
+            .dist         = vals[2]
         });
     }
 
+    return parsed;
+}
+
+// A piece of one seed range, [start, stop)
+struct SeedSlice{
+    int64_t start = 0;
+    int64_t stop  = 0;
+};
+
+static constexpr int64_t slice_seeds = 1 << 20;
+
+// Lowest location seen, starting from no location at all so it can be folded from a
+// value initialised result
+struct MinLocation{
+    int64_t value = std::numeric_limits<int64_t>::max();
+};
+
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const std::vector<int64_t>& seeds = parsed.seeds;
+    const std::array<std::vector<RangeMap>, 7>& map_groups = parsed.map_groups;
+
     // Apply each seed to find the locations
     std::vector<int64_t> locations(seeds.size());
     for (auto [seed, location] : std::views::zip(seeds, locations)){
@@ -90,35 +124,73 @@ int main(){
     }
 
     int64_t closest_location = *std::min_element(locations.begin(), locations.end());
-    std::println("The closest location is {} for problem 1", closest_location);
-
-    // Problem 2
-    auto seed_ranges = seeds 
-        | std::views::chunk(2) 
-        | std::views::transform([](auto seed_pair){return std::views::iota(seed_pair[0], seed_pair[0] + seed_pair[1]);});
-    size_t num_ranges = std::ranges::distance(seed_ranges);
-
-    // There's a lot of number crunching, so split it up between threads
-    std::vector<int64_t> min_locations(num_ranges, std::numeric_limits<int64_t>::max());
-    std::vector<std::thread> workers(num_ranges);                       
-    
-    // Same as problem 1, but with the seed ranges we calculated above                                                                                                                                                                                                                                                                                                                                          ;
-    for (auto [idx, seed_range] : seed_ranges | std::views::enumerate){
-        int64_t& min_location = min_locations[idx];
-        workers[idx] = std::thread([&min_location, seed_range, &map_groups, idx](){
-            std::println("Starting processing seed range {}", idx, (size_t)&min_location);
-            for (int64_t seed : seed_range){
-                for (const std::vector<RangeMap>& map_group : map_groups){
-                    seed = mapToNext(seed, map_group);
-                }
-                min_location = std::min(min_location, seed);
+
+    // Problem 2. There's a lot of number crunching, so the seed ranges are cut into slices
+    // and spread over the shared thread pool. Slicing keeps the work even however the
+    // range lengths vary, and the thread count no longer grows with the number of ranges
+    std::vector<SeedSlice> slices;
+    for (auto seed_pair : seeds | std::views::chunk(2)){
+        if (seed_pair.size() < 2) break;
+        for (int64_t start = seed_pair[0]; start < seed_pair[0] + seed_pair[1]; start += slice_seeds){
+            slices.push_back(SeedSlice{.start = start, .stop = std::min(start + slice_seeds, seed_pair[0] + seed_pair[1])});
+        }
+    }
+    AOC_LOG(DEBUG, "Mapping {} seed slices", slices.size());
+
+    // Same as problem 1, but over every seed of each slice
+    const MinLocation min_location = aoc::LineEngine{}.mapReduceItems(std::span(slices), [&](const SeedSlice& slice){
+        MinLocation slice_min;
+        for (int64_t seed = slice.start; seed < slice.stop; seed++){
+            int64_t location = seed;
+            for (const std::vector<RangeMap>& map_group : map_groups){
+                location = mapToNext(location, map_group);
             }
-            std::println("Done processing seed range {}", idx);
-        });
+            slice_min.value = std::min(slice_min.value, location);
+        }
+        AOC_COUNT("seeds_mapped", slice.stop - slice.start);
+        return slice_min;
+    }, [](MinLocation a, MinLocation b){return MinLocation{std::min(a.value, b.value)};}, 1);
+
+    return aoc::Answer{
+        .part1 = closest_location,
+        .part2 = min_location.value
+    };
+}
+
+// Parse cache layout: the seeds, then each map group as (dest, source, dist) triples
+void save(const Parsed& parsed, std::string_view /*input*/, aoc::cache::Writer& writer){
+    writer.writeArray(parsed.seeds);
+    for (const std::vector<RangeMap>& map_group : parsed.map_groups){
+        writer.writeArray(map_group
+            | std::views::transform([](const RangeMap& map){return std::array{map.dest_start, map.source_start, map.dist};})
+            | std::ranges::to<std::vector>());
     }
+}
 
-    for (std::thread& t : workers){
-        t.join();
+Parsed load(aoc::cache::Reader& reader, std::string_view /*input*/){
+    Parsed parsed{.seeds = reader.readArray<int64_t>()};
+    for (std::vector<RangeMap>& map_group : parsed.map_groups){
+        for (auto [dest_start, source_start, dist] : reader.readArray<std::array<int64_t, 3>>()){
+            map_group.emplace_back(RangeMap{.dest_start = dest_start, .source_start = source_start, .dist = dist});
+        }
     }
-    std::println("The closest location is {} for problem 2", *std::min_element(min_locations.begin(), min_locations.end()));
-}
\ No newline at end of file
+    return parsed;
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(5, parse, solve, aoc::cache::CacheIO<Parsed>{.schema_version = 1, .save = save, .load = load});
+}
+
+} // namespace day5
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input = mapInput(day5::filename);
+    day5::Parsed parsed = day5::parse(input);
+    aoc::Answer answer = day5::solve(parsed);
+
+    std::println("The closest location is {} for problem 1", answer.part1);
+    std::println("The closest location is {} for problem 2", answer.part2);
+    AOC_INSTRUMENT_REPORT(5, input.size());
+}
+#endif
@@ -2,11 +2,16 @@
 #include <string>
 #include <ranges>
 #include <vector>
-#include <fstream>
+#include <span>
 
-bool isDigit(char c){
-    return c >= '0' && c <= '9';
-}
+#include "load_input.hpp"
+#include "parse_numbers.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
+namespace day6{
+
+static constexpr std::string filename{"day_6_data.txt"};
 
 long long holdTimeToWin(long long dist, long long total_time){
     double root = std::sqrt(total_time*total_time - 4*dist);
@@ -18,30 +23,38 @@ long long numWinningSolutions(long long dist, long long total_time){
     return total_time - 2*breakpoint - 1; // -1 since we count zero as well
 }
 
-int main(){
-    // Read the input into a string
-    std::ifstream text_file{"day_6_data.txt"};
+struct Parsed{
+    std::vector<int> time_vals;
+    std::vector<int> dist_vals;
+};
+
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    auto lines = input | std::views::split('\n');
+    auto line_it = lines.begin();
 
     // Parse the data to get the inputs
-    auto parseNextLine = [&text_file]() -> std::vector<int> {
-        std::string str;
-        std::getline(text_file, str);
-        return str 
-            | std::views::drop_while([](char c){return !isDigit(c);})
-            | std::views::chunk_by([](char c1, char c2){return !(isDigit(c1) ^ isDigit(c2));})
-            | std::views::stride(2)
-            | std::views::transform([](auto chunk){return std::atoi(chunk.data());})
-            | std::ranges::to<std::vector<int>>();
+    auto parseNextLine = [&line_it, &lines]() -> std::vector<int> {
+        if (line_it == lines.end()) return {};
+        std::string_view str(*line_it++);
+        std::vector<int> vals(str.size()/2 + 1);
+        vals.resize(aoc::parseIntegers(str, std::span(vals)));
+        return vals;
     };
-    std::vector<int> time_vals = parseNextLine();
-    std::vector<int> dist_vals = parseNextLine();
 
+    Parsed parsed;
+    parsed.time_vals = parseNextLine();
+    parsed.dist_vals = parseNextLine();
+    return parsed;
+}
+
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
     // Solve the problem
     long long product = 1;
-    for (auto [time, dist] : std::views::zip(time_vals, dist_vals)){
+    for (auto [time, dist] : std::views::zip(parsed.time_vals, parsed.dist_vals)){
         product *= numWinningSolutions(dist, time);
     }
-    std::println("The total product was {}", product);
 
     // Reparse the problem 2 version
     auto reparse = [](const std::vector<int>& v) -> long long {
@@ -51,10 +64,28 @@ int main(){
             | std::ranges::to<std::string>();
         return std::stoll(as_one_int);
     };
-    long long big_dist = reparse(dist_vals);
-    long long big_time = reparse(time_vals);
-    
-    std::println("Winning solutions: {}", numWinningSolutions(big_dist, big_time));
+    long long big_dist = reparse(parsed.dist_vals);
+    long long big_time = reparse(parsed.time_vals);
+
+    return aoc::Answer{.part1 = product, .part2 = numWinningSolutions(big_dist, big_time)};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(6, parse, solve);
+}
+
+} // namespace day6
 
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input = mapInput(day6::filename);
+    day6::Parsed parsed = day6::parse(input);
+    aoc::Answer answer = day6::solve(parsed);
+
+    std::println("The total product was {}", answer.part1);
+    std::println("Winning solutions: {}", answer.part2);
+
+    AOC_INSTRUMENT_REPORT(6, input.size());
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -1,15 +1,21 @@
 #include <print>
 #include <array>
-#include <deque>
 #include <string>
 #include <ranges>
-#include <fstream>
-#include <sstream>
+#include <vector>
 #include <algorithm>
 #include <unordered_map>
-#include <spanstream>
 
-constexpr std::string filename{"day_7_data.txt"};
+#include "load_input.hpp"
+#include "line_engine.hpp"
+#include "parse_numbers.hpp"
+#include "log.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
+namespace day7{
+
+static constexpr std::string filename{"day_7_data.txt"};
 
 struct Hand{
     std::array<int, 5> cards;
@@ -147,41 +153,44 @@ ScoredHand rescore(const ScoredHand& scored_hand){
     return new_hand;
 }
 
-int main(){
-    std::ifstream text_file{filename};
+// Hand and bid from a line such as "32T3K 765"
+Hand parseHand(std::string_view line){
+    auto cards = line
+        | std::views::take(5)
+        | std::views::transform([](char c){return card_map.at(c);});
+
+    Hand hand{.cards = {cards[0], cards[1], cards[2], cards[3], cards[4]}};
+    hand.bid = aoc::parseInteger<decltype(hand.bid)>(line.substr(6));
+    return hand;
+}
+
+struct Parsed{
+    std::vector<Hand> hands;
+};
 
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
     // Extract the hands and bids
-    std::deque<Hand> hands;
-    for (std::string line; std::getline(text_file, line);){
-        auto cards = line
-            | std::views::take(5)
-            | std::views::transform([](char c){return card_map.at(c);});
-        auto bid = line | std::views::drop(6);
-
-        hands.push_back(Hand{
-            .cards = {cards[0], cards[1], cards[2], cards[3], cards[4]},
-            .bid = std::atoi(bid.data())
-        });
-    }
+    return Parsed{.hands = aoc::LineEngine{}.mapLines(input, parseHand)};
+}
 
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
     // Score the hands
-    std::vector<ScoredHand> scored_hands = hands 
-        | std::views::transform([](Hand& h){return scoreHand(h);})
+    std::vector<ScoredHand> scored_hands = parsed.hands 
+        | std::views::transform([](const Hand& h){return scoreHand(h);})
         | std::ranges::to<std::vector<ScoredHand>>();
 
     // Sort the scored hands
     std::ranges::sort(scored_hands.begin(), scored_hands.end(), scoreLess);
-    std::println("Sorted hands: ");
 
     // Determine the final answer
     long long winnings = 0;
     for (auto [rank, sorted_hand] : std::views::enumerate(scored_hands)){
         winnings += (rank+1) * sorted_hand.hand.bid;
     }
-    std::println("Initial winnings are ${}", winnings);
 
     // Problem 2
-    std::println("Adding the joker rule and recalculating...");
     std::vector<ScoredHand> scored_with_new_rules = scored_hands
         | std::views::transform(rescore)
         | std::ranges::to<std::vector<ScoredHand>>();
@@ -192,13 +201,40 @@ int main(){
     // Recalculate the winnings
     long long new_winnings = 0;
     for (auto [rank, sorted_hand] : std::views::enumerate(scored_with_new_rules)){
-        for (auto elem : sorted_hand.hand.cards){
-            std::print("{: <2}, ", elem);
-        }
-        std::println(" : {} - Rank {}", (int)sorted_hand.label, rank+1);
+        const auto& cards = sorted_hand.hand.cards;
+        AOC_LOG(TRACE, "{: <2}, {: <2}, {: <2}, {: <2}, {: <2},  : {} - Rank {}",
+            cards[0], cards[1], cards[2], cards[3], cards[4], static_cast<int>(sorted_hand.label), rank+1);
         new_winnings += (rank+1) * sorted_hand.hand.bid;
     }
-    std::println("Final winnings are ${}", new_winnings);
 
+    return aoc::Answer{.part1 = winnings, .part2 = new_winnings};
+}
+
+// Parse cache layout: the hands as one flat array
+void save(const Parsed& parsed, std::string_view /*input*/, aoc::cache::Writer& writer){
+    writer.writeArray(parsed.hands);
+}
+
+Parsed load(aoc::cache::Reader& reader, std::string_view /*input*/){
+    return Parsed{.hands = reader.readArray<Hand>()};
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(7, parse, solve, aoc::cache::CacheIO<Parsed>{.schema_version = 1, .save = save, .load = load});
+}
+
+} // namespace day7
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input = mapInput(day7::filename);
+    day7::Parsed parsed = day7::parse(input);
+    aoc::Answer answer = day7::solve(parsed);
+
+    std::println("Initial winnings are ${}", answer.part1);
+    std::println("Final winnings are ${}", answer.part2);
+
+    AOC_INSTRUMENT_REPORT(7, input.size());
     return 0;
-}
\ No newline at end of file
+}
+#endif
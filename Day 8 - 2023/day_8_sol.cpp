@@ -1,38 +1,60 @@
 #include <print>
+#include <array>
 #include <ranges>
 #include <string>
-#include <fstream>
+#include <vector>
 #include <numeric>
 #include <functional>
-#include <unordered_set>
-#include <unordered_map>
 #include <algorithm>
 
+#include "load_input.hpp"
+#include "flat_hash_map.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
 using namespace std::string_view_literals;
 
+namespace day8{
+
 static constexpr std::string filename{"day_8_data.txt"};
 
-int main(){
-    // Open the files and extract the first line
-    std::ifstream text_file(filename);
+struct Parsed{
     std::string instructions;
-    std::getline(text_file, instructions);
+    aoc::FlatHashMap<std::string, std::pair<std::string, std::string>> desert_map;
+};
 
-    // Skip over empty line
-    text_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    Parsed parsed;
+    auto lines = input | std::views::split('\n') | std::views::transform([](auto line){return std::string_view(line);});
 
-    // Load the nodes from the rest of the input into a map
-    std::unordered_map<std::string, std::pair<std::string, std::string>> desert_map;
-    for (std::string line; std::getline(text_file, line);){
-        std::string label = line.substr(0, 3);
-        std::string dest1 = line.substr(7, 3);
-        std::string dest2 = line.substr(12, 3);
+    // Extract the first line and skip over the empty line after it
+    auto line_it = lines.begin();
+    if (line_it == lines.end()) return parsed;
+    parsed.instructions = std::string(*line_it);
+    std::ranges::advance(line_it, 2, lines.end());
 
-        desert_map.insert({label, {dest1, dest2}});
+    // Load the nodes from the rest of the input into a map, every node takes one line
+    parsed.desert_map.reserve(std::ranges::count(input, '\n'));
+    for (std::string_view line : std::ranges::subrange(line_it, lines.end())){
+        if (line.size() < 15) continue;
+        std::string label{line.substr(0, 3)};
+        std::string dest1{line.substr(7, 3)};
+        std::string dest2{line.substr(12, 3)};
+
+        parsed.desert_map.insert({label, {dest1, dest2}});
     }
+    return parsed;
+}
+
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
+    const std::string& instructions = parsed.instructions;
+    const auto& desert_map = parsed.desert_map;
 
-    // Make walk function so it can be reused for part 2
-    auto walkToEnd = [&desert_map, &instructions](std::string current, std::function<bool(const std::string&)> termination) -> size_t {
+    // Make walk function so it can be reused for part 2. The current label views the map's own
+    // strings, so each step is a single lookup with no copies
+    auto walkToEnd = [&desert_map, &instructions](std::string_view current, std::function<bool(std::string_view)> termination) -> size_t {
         size_t num_steps = 0;
         for (char instruction : std::views::repeat(instructions) | std::views::join){
             if (termination(current)) break;
@@ -42,12 +64,11 @@ int main(){
         }
         return num_steps;
     }; 
-    size_t num_steps = walkToEnd("AAA", [](const std::string& s){return s == "ZZZ";});
-    std::println("Took {} steps", num_steps);
+    size_t num_steps = walkToEnd("AAA", [](std::string_view s){return s == "ZZZ";});
 
     // Problem 2 solution
-    auto endsWithA  = [](const std::string& s){return s.ends_with("A");};
-    auto endsWithZ  = [](const std::string& s){return s.ends_with("Z");};
+    auto endsWithA  = [](std::string_view s){return s.ends_with("A");};
+    auto endsWithZ  = [](std::string_view s){return s.ends_with("Z");};
     auto steps_to_Z = std::bind(walkToEnd, std::placeholders::_1, endsWithZ);
 
     std::optional<size_t> walk_steps = std::ranges::fold_left_first(
@@ -58,7 +79,60 @@ int main(){
 
         std::lcm<size_t, size_t>
     );
-    std::println("Minimum steps is {}", walk_steps.value());
 
+    return aoc::Answer{
+        .part1 = static_cast<int64_t>(num_steps),
+        .part2 = static_cast<int64_t>(walk_steps.value_or(0))
+    };
+}
+
+// Parse cache layout: the instructions, then every node as its label and two destinations
+struct NodeRecord{
+    std::array<char, 3> label;
+    std::array<char, 3> left;
+    std::array<char, 3> right;
+};
+
+void save(const Parsed& parsed, std::string_view /*input*/, aoc::cache::Writer& writer){
+    auto toLabel = [](const std::string& s){return std::array<char, 3>{s[0], s[1], s[2]};};
+    writer.writeArray(parsed.instructions);
+    writer.writeArray(parsed.desert_map
+        | std::views::transform([&](const auto& node){
+            const auto& [label, dests] = node;
+            return NodeRecord{toLabel(label), toLabel(dests.first), toLabel(dests.second)};
+        })
+        | std::ranges::to<std::vector>());
+}
+
+Parsed load(aoc::cache::Reader& reader, std::string_view /*input*/){
+    auto toString = [](const std::array<char, 3>& label){return std::string(label.data(), label.size());};
+    const std::vector<char> instructions = reader.readArray<char>();
+    const std::vector<NodeRecord> nodes  = reader.readArray<NodeRecord>();
+
+    Parsed parsed{.instructions = std::string(instructions.begin(), instructions.end())};
+    parsed.desert_map.reserve(nodes.size());
+    for (const NodeRecord& node : nodes){
+        parsed.desert_map.insert({toString(node.label), {toString(node.left), toString(node.right)}});
+    }
+    return parsed;
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(8, parse, solve, aoc::cache::CacheIO<Parsed>{.schema_version = 1, .save = save, .load = load});
+}
+
+} // namespace day8
+
+#ifndef AOC_LIBRARY
+int main(){
+    MappedInput input = mapInput(day8::filename);
+    day8::Parsed parsed = day8::parse(input);
+    aoc::Answer answer = day8::solve(parsed);
+
+    std::println("Took {} steps", answer.part1);
+    std::println("Minimum steps is {}", answer.part2);
+
+    AOC_INSTRUMENT_REPORT(8, input.size());
     return 0;
 }
+#endif
@@ -2,49 +2,96 @@
 #include <ranges>
 #include <vector>
 #include <chrono>
+#include <span>
+#include <iterator>
 #include <algorithm>
+#include <functional>
 
 #include "load_input.hpp"
+#include "arena.hpp"
+#include "line_engine.hpp"
+#include "stream_reader.hpp"
+#include "parse_numbers.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+
+namespace day9{
+
+static constexpr std::string filename{"day_9_data.txt"};
 
 using data_t = int64_t;
 
-std::pair<data_t, data_t> getNextInSequence(const std::vector<data_t>& seq){
+// Every level of differences is allocated from scratch
+std::pair<data_t, data_t> getNextInSequence(std::span<const data_t> seq, std::pmr::memory_resource* scratch){
     // If all are zero, return 0
-    if (seq.empty() || std::ranges::all_of(seq, [](int i){return i == 0;})) return {0, 0};    
+    if (seq.empty() || std::ranges::all_of(seq, [](data_t i){return i == 0;})) return {0, 0};    
 
     // Recursively call for the next
-    std::vector<data_t> next_level = seq 
-        | std::views::adjacent_transform<2>([](data_t a, data_t b){return b - a;}) 
-        | std::ranges::to<std::vector<data_t>>();
-    auto [next_first, next_last] = getNextInSequence(next_level);
+    std::pmr::vector<data_t> next_level(scratch);
+    next_level.reserve(seq.size() - 1);
+    std::ranges::copy(seq | std::views::adjacent_transform<2>([](data_t a, data_t b){return b - a;}), std::back_inserter(next_level));
+    auto [next_first, next_last] = getNextInSequence(next_level, scratch);
 
     return {seq.front() - next_first, seq.back() + next_last};
 }
 
-int main(){
-    auto start = std::chrono::steady_clock::now();
-    std::string input_data = loadInput("day_9_data.txt");
-    
-    // Convert the input to a range of vectors of ints
-    auto int_ranges = input_data 
-        | std::views::split('\n')
-        | std::views::transform([](auto line){
-            return line 
-                | std::views::split(' ')
-                | std::views::transform([](auto chunk){return std::atoll(chunk.data());})
-                | std::ranges::to<std::vector<data_t>>();
-        });
+std::vector<data_t> parseSequence(std::string_view line){
+    std::vector<data_t> vals(line.size()/2 + 1);
+    vals.resize(aoc::parseIntegers(line, std::span(vals)));
+    return vals;
+}
+
+// Next value (part 1) and previous value (part 2) of one sequence
+aoc::Answer extrapolate(std::span<const data_t> vals){
+    aoc::StackArena<16 * 1024> scratch;
+    auto [front_val, back_val] = getNextInSequence(vals, &scratch);
+    return aoc::Answer{.part1 = back_val, .part2 = front_val};
+}
+
+struct Parsed{
+    std::vector<std::vector<data_t>> sequences;
+};
+
+// Lines are converted to sequences in parallel
+Parsed parse(std::string_view input){
+    AOC_SCOPED_TIMER("parse");
+    return Parsed{.sequences = aoc::LineEngine{}.mapLines(input, parseSequence)};
+}
 
+// Every sequence is extrapolated on its own, so solving is one parallel pass
+aoc::Answer solve(const Parsed& parsed){
+    AOC_SCOPED_TIMER("solve");
     // Might as well solve both parts at the same time
-    int64_t front_sum = 0;
-    int64_t back_sum = 0;
-    for (const std::vector<data_t>& line_of_ints : int_ranges){
-        auto [front_val, back_val] = getNextInSequence(line_of_ints);
-        front_sum += front_val;
-        back_sum += back_val;
-    }
+    return aoc::LineEngine{}.mapReduceItems(std::span(parsed.sequences), [](const std::vector<data_t>& vals){return extrapolate(vals);}, std::plus{});
+}
+
+// Same answers as parse and solve, reading the input a block at a time so memory use stays
+// constant however large it is
+aoc::Answer solveStream(aoc::StreamReader& reader){
+    AOC_SCOPED_TIMER("solve");
+    return aoc::mapReduceStream(reader, [](std::string_view line){
+        aoc::StackArena<4 * 1024> scratch;
+        std::pmr::vector<data_t> vals(line.size()/2 + 1, &scratch);
+        vals.resize(aoc::parseIntegers(line, std::span(vals)));
+        return extrapolate(vals);
+    }, std::plus{});
+}
+
+aoc::Solver solver(){
+    return aoc::makeSolver(9, parse, solve);
+}
+
+} // namespace day9
+
+#ifndef AOC_LIBRARY
+int main(){
+    auto start = std::chrono::steady_clock::now();
+    aoc::StreamReader reader(day9::filename);
+    aoc::Answer answer = day9::solveStream(reader);
 
     auto stop = std::chrono::steady_clock::now();
-    std::println("Front sum is {} and Back sum is {}", front_sum, back_sum);
+    std::println("Front sum is {} and Back sum is {}", answer.part2, answer.part1);
     std::println("Calculations took {} us", std::chrono::duration_cast<std::chrono::microseconds>(stop-start).count());
-}
\ No newline at end of file
+    AOC_INSTRUMENT_REPORT(9, reader.bytesRead());
+}
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
+namespace aoc{
+
+// Bump allocator for the containers of one run. Deallocation is a no-op and everything
+// is released at once when the arena is destroyed, so containers allocated from it must
+// be destroyed first. Pass &arena wherever a std::pmr::memory_resource* is expected:
+//
+//     aoc::Arena arena;
+//     std::pmr::vector<int> values(&arena);
+//
+// Not thread safe, give each thread its own arena
+class Arena : public std::pmr::monotonic_buffer_resource{
+public:
+    static constexpr size_t default_block_bytes = 64 * 1024;
+
+    explicit Arena(size_t initial_bytes = default_block_bytes) : monotonic_buffer_resource(initial_bytes) {}
+};
+
+namespace detail{
+
+template<size_t N>
+struct InlineBuffer{
+    alignas(std::max_align_t) std::array<std::byte, N> inline_buffer;
+};
+
+} // namespace detail
+
+// Arena whose first N bytes live inside the object itself, for scratch containers
+// that only live as long as one line or one call and usually never touch the heap
+template<size_t N>
+class StackArena : private detail::InlineBuffer<N>, public std::pmr::monotonic_buffer_resource{
+public:
+    StackArena() : monotonic_buffer_resource(this->inline_buffer.data(), N) {}
+};
+
+} // namespace aoc
@@ -0,0 +1,550 @@
+#pragma once
+
+#include <bit>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <functional>
+#include <string_view>
+#include <memory_resource>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Open addressing hash table in the style of Abseil's SwissTable. Each slot has
+// a control byte holding 7 bits of its hash, and lookups compare 16 control bytes
+// at a time (with SSE2 where available) so most probes touch a single cache line
+// of metadata before ever looking at a key. Elements live inline in one flat array
+// rather than in individually allocated nodes.
+//
+// References and iterators are invalidated by any insertion that grows the table,
+// so reserve() up front when the final size is known.
+
+namespace aoc{
+
+// Default hasher. Strings hash through std::string_view so maps keyed on std::string
+// can be searched with a std::string_view without building a key
+template<typename Key>
+struct Hash : std::hash<Key>{};
+
+template<>
+struct Hash<std::string>{
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const {return std::hash<std::string_view>{}(str);}
+};
+
+template<>
+struct Hash<std::string_view> : Hash<std::string>{};
+
+namespace detail{
+
+// Control byte values. Full slots hold the low 7 bits of their hash instead
+static constexpr int8_t ctrl_empty   = -128;
+static constexpr int8_t ctrl_deleted = -2;
+
+static constexpr size_t group_width = 16;
+
+struct alignas(group_width) CtrlGroup{
+    int8_t bytes[group_width];
+};
+
+// Bitmasks of the control bytes in one group matching some condition
+class Group{
+public:
+    explicit Group(const CtrlGroup& group){
+#if defined(__SSE2__)
+        ctrl_ = _mm_load_si128(reinterpret_cast<const __m128i*>(group.bytes));
+#else
+        std::memcpy(ctrl_, group.bytes, group_width);
+#endif
+    }
+
+    uint32_t match(int8_t h2) const {
+#if defined(__SSE2__)
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2)));
+#else
+        uint32_t mask = 0;
+        for (size_t idx = 0; idx < group_width; idx++) mask |= static_cast<uint32_t>(ctrl_[idx] == h2) << idx;
+        return mask;
+#endif
+    }
+
+    uint32_t matchEmpty() const {return match(ctrl_empty);}
+
+    // Empty and deleted are the only control bytes with the top bit set
+    uint32_t matchFree() const {
+#if defined(__SSE2__)
+        return _mm_movemask_epi8(ctrl_);
+#else
+        uint32_t mask = 0;
+        for (size_t idx = 0; idx < group_width; idx++) mask |= static_cast<uint32_t>(ctrl_[idx] < 0) << idx;
+        return mask;
+#endif
+    }
+
+private:
+#if defined(__SSE2__)
+    __m128i ctrl_;
+#else
+    int8_t ctrl_[group_width];
+#endif
+};
+
+// Spread the entropy of weak hashes (std::hash of an int is the identity) over every bit
+inline uint64_t mixHash(uint64_t hash){
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Storage and probing shared by the map and the set. KeyOf extracts the key from a stored value
+template<typename Value, typename KeyOf, typename Hasher, typename KeyEqual, typename Allocator>
+class FlatTable{
+    using ValueAlloc  = typename std::allocator_traits<Allocator>::template rebind_alloc<Value>;
+    using CtrlAlloc   = typename std::allocator_traits<Allocator>::template rebind_alloc<CtrlGroup>;
+    using ValueTraits = std::allocator_traits<ValueAlloc>;
+    using CtrlTraits  = std::allocator_traits<CtrlAlloc>;
+
+    template<typename K>
+    static constexpr bool is_lookup_key = requires {
+        typename Hasher::is_transparent;
+        typename KeyEqual::is_transparent;
+    } || std::is_convertible_v<const K&, const std::remove_cvref_t<decltype(KeyOf{}(std::declval<const Value&>()))>&>;
+
+public:
+    using key_type        = std::remove_cvref_t<decltype(KeyOf{}(std::declval<const Value&>()))>;
+    using value_type      = Value;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher          = Hasher;
+    using key_equal       = KeyEqual;
+    using allocator_type  = Allocator;
+
+    template<bool Const>
+    class Iterator{
+    public:
+        using iterator_concept  = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = FlatTable::value_type;
+        using difference_type   = ptrdiff_t;
+        using pointer           = std::conditional_t<Const, const Value*, Value*>;
+        using reference         = std::conditional_t<Const, const Value&, Value&>;
+
+        Iterator() = default;
+        Iterator(const int8_t* ctrl, const int8_t* ctrl_end, pointer slot) : ctrl_(ctrl), ctrl_end_(ctrl_end), slot_(slot) {
+            skipFree();
+        }
+        operator Iterator<true>() const requires (!Const) {return {ctrl_, ctrl_end_, slot_};}
+
+        reference operator*()  const {return *slot_;}
+        pointer   operator->() const {return slot_;}
+
+        Iterator& operator++(){
+            ++ctrl_;
+            ++slot_;
+            skipFree();
+            return *this;
+        }
+        Iterator operator++(int){
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const {return ctrl_ == other.ctrl_;}
+
+    private:
+        void skipFree(){
+            while (ctrl_ != ctrl_end_ && *ctrl_ < 0){
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+
+        const int8_t* ctrl_     = nullptr;
+        const int8_t* ctrl_end_ = nullptr;
+        pointer slot_           = nullptr;
+    };
+
+    using iterator       = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatTable() = default;
+    explicit FlatTable(size_t capacity, const Allocator& alloc = Allocator()) : value_alloc_(alloc), ctrl_alloc_(alloc) {
+        reserve(capacity);
+    }
+    explicit FlatTable(const Allocator& alloc) : value_alloc_(alloc), ctrl_alloc_(alloc) {}
+
+    FlatTable(const FlatTable& other) :
+        value_alloc_(ValueTraits::select_on_container_copy_construction(other.value_alloc_)),
+        ctrl_alloc_(CtrlTraits::select_on_container_copy_construction(other.ctrl_alloc_)),
+        hash_(other.hash_),
+        equal_(other.equal_)
+    {
+        reserve(other.size_);
+        for (const Value& value : other) insertUnique(other.hashOf(KeyOf{}(value)), value);
+    }
+
+    FlatTable(FlatTable&& other) noexcept :
+        ctrl_(std::exchange(other.ctrl_, nullptr)),
+        slots_(std::exchange(other.slots_, nullptr)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        size_(std::exchange(other.size_, 0)),
+        growth_left_(std::exchange(other.growth_left_, 0)),
+        value_alloc_(std::move(other.value_alloc_)),
+        ctrl_alloc_(std::move(other.ctrl_alloc_)),
+        hash_(std::move(other.hash_)),
+        equal_(std::move(other.equal_))
+    {}
+
+    FlatTable& operator=(FlatTable other) noexcept requires std::allocator_traits<Allocator>::is_always_equal::value {
+        swap(other);
+        return *this;
+    }
+
+    // Allocators that aren't interchangeable (e.g. pmr arenas) keep their own storage and copy elements across
+    FlatTable& operator=(const FlatTable& other) requires (!std::allocator_traits<Allocator>::is_always_equal::value) {
+        if (this == &other) return *this;
+        clear();
+        reserve(other.size_);
+        for (const Value& value : other) insertUnique(hashOf(KeyOf{}(value)), value);
+        return *this;
+    }
+
+    FlatTable& operator=(FlatTable&& other) requires (!std::allocator_traits<Allocator>::is_always_equal::value) {
+        if (this == &other) return *this;
+        if (value_alloc_ == other.value_alloc_){
+            destroyAll();
+            release();
+            ctrl_        = std::exchange(other.ctrl_, nullptr);
+            slots_       = std::exchange(other.slots_, nullptr);
+            capacity_    = std::exchange(other.capacity_, 0);
+            size_        = std::exchange(other.size_, 0);
+            growth_left_ = std::exchange(other.growth_left_, 0);
+        }else{
+            clear();
+            reserve(other.size_);
+            for (Value& value : other) insertUnique(hashOf(KeyOf{}(value)), std::move(value));
+            other.clear();
+        }
+        return *this;
+    }
+
+    ~FlatTable(){
+        destroyAll();
+        release();
+    }
+
+    void swap(FlatTable& other) noexcept {
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(slots_, other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+        std::swap(value_alloc_, other.value_alloc_);
+        std::swap(ctrl_alloc_, other.ctrl_alloc_);
+        std::swap(hash_, other.hash_);
+        std::swap(equal_, other.equal_);
+    }
+
+    iterator       begin()       {return {ctrlBytes(), ctrlBytes() + capacity_, slots_};}
+    const_iterator begin() const {return {ctrlBytes(), ctrlBytes() + capacity_, slots_};}
+    iterator       end()         {return {ctrlBytes() + capacity_, ctrlBytes() + capacity_, slots_ + capacity_};}
+    const_iterator end()   const {return {ctrlBytes() + capacity_, ctrlBytes() + capacity_, slots_ + capacity_};}
+
+    size_t size()     const {return size_;}
+    bool   empty()    const {return size_ == 0;}
+    size_t capacity() const {return capacity_;}
+    allocator_type get_allocator() const {return allocator_type(value_alloc_);}
+
+    // Make room for count elements without any further rehashing
+    void reserve(size_t count){
+        if (count > size_ + growth_left_) rehash(capacityFor(count));
+    }
+
+    void clear(){
+        destroyAll();
+        size_ = 0;
+        if (capacity_ != 0) resetCtrl();
+    }
+
+    template<typename K> requires is_lookup_key<K>
+    iterator find(const K& key){
+        const size_t idx = findIndex(key, hashOf(key));
+        return idx == npos ? end() : iteratorAt(idx);
+    }
+
+    template<typename K> requires is_lookup_key<K>
+    const_iterator find(const K& key) const {
+        const size_t idx = findIndex(key, hashOf(key));
+        return idx == npos ? end() : iteratorAt(idx);
+    }
+
+    template<typename K> requires is_lookup_key<K>
+    bool contains(const K& key) const {return findIndex(key, hashOf(key)) != npos;}
+
+    template<typename K> requires is_lookup_key<K>
+    size_t count(const K& key) const {return contains(key) ? 1 : 0;}
+
+    std::pair<iterator, bool> insert(const Value& value){return emplaceValue(value);}
+    std::pair<iterator, bool> insert(Value&& value){return emplaceValue(std::move(value));}
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args){
+        return emplaceValue(Value(std::forward<Args>(args)...));
+    }
+
+    template<typename K> requires is_lookup_key<K>
+    size_t erase(const K& key){
+        const size_t idx = findIndex(key, hashOf(key));
+        if (idx == npos) return 0;
+        eraseAt(idx);
+        return 1;
+    }
+
+    iterator erase(iterator pos){return erase(const_iterator(pos));}
+
+    iterator erase(const_iterator pos){
+        const size_t idx = pos.operator->() - slots_;
+        eraseAt(idx);
+        return iteratorAt(idx);
+    }
+
+protected:
+    static constexpr size_t npos = SIZE_MAX;
+
+    template<typename K>
+    size_t hashOf(const K& key) const {return mixHash(hash_(key));}
+
+    template<typename K>
+    size_t findIndex(const K& key, size_t hash) const {
+        if (capacity_ == 0) return npos;
+        const int8_t h2 = static_cast<int8_t>(hash & 0x7F);
+        const size_t group_mask = capacity_/group_width - 1;
+
+        // Triangular probing over whole groups visits every group of a power of two table
+        size_t group = (hash >> 7) & group_mask;
+        for (size_t probe = 1;; probe++){
+            const Group ctrl(ctrl_[group]);
+            for (uint32_t matches = ctrl.match(h2); matches != 0; matches &= matches - 1){
+                const size_t idx = group*group_width + std::countr_zero(matches);
+                if (equal_(KeyOf{}(slots_[idx]), key)) return idx;
+            }
+            if (ctrl.matchEmpty() != 0) return npos;
+            group = (group + probe) & group_mask;
+        }
+    }
+
+    // Look the key up and construct the value in place with make_value() if it isn't there yet
+    template<typename K, typename F>
+    std::pair<iterator, bool> findOrInsert(const K& key, F&& make_value){
+        const size_t hash = hashOf(key);
+        const size_t found = findIndex(key, hash);
+        if (found != npos) return {iteratorAt(found), false};
+
+        if (growth_left_ == 0) rehash(capacityFor(size_ + 1));
+        const size_t idx = findFreeIndex(hash);
+        ValueTraits::construct(value_alloc_, slots_ + idx, make_value());
+        markFull(idx, hash);
+        return {iteratorAt(idx), true};
+    }
+
+    iterator iteratorAt(size_t idx){return {ctrlBytes() + idx, ctrlBytes() + capacity_, slots_ + idx};}
+    const_iterator iteratorAt(size_t idx) const {return {ctrlBytes() + idx, ctrlBytes() + capacity_, slots_ + idx};}
+
+private:
+    template<typename V>
+    std::pair<iterator, bool> emplaceValue(V&& value){
+        return findOrInsert(KeyOf{}(value), [&]() -> V&& {return std::forward<V>(value);});
+    }
+
+    // Insert a value known not to be present
+    template<typename V>
+    void insertUnique(size_t hash, V&& value){
+        const size_t idx = findFreeIndex(hash);
+        ValueTraits::construct(value_alloc_, slots_ + idx, std::forward<V>(value));
+        markFull(idx, hash);
+    }
+
+    size_t findFreeIndex(size_t hash) const {
+        const size_t group_mask = capacity_/group_width - 1;
+        size_t group = (hash >> 7) & group_mask;
+        for (size_t probe = 1;; probe++){
+            const uint32_t free = Group(ctrl_[group]).matchFree();
+            if (free != 0) return group*group_width + std::countr_zero(free);
+            group = (group + probe) & group_mask;
+        }
+    }
+
+    void markFull(size_t idx, size_t hash){
+        int8_t& ctrl = ctrlBytes()[idx];
+        if (ctrl == ctrl_empty) growth_left_--;
+        ctrl = static_cast<int8_t>(hash & 0x7F);
+        size_++;
+    }
+
+    void eraseAt(size_t idx){
+        ValueTraits::destroy(value_alloc_, slots_ + idx);
+        size_--;
+
+        // A group that still has an empty slot ends every probe that reaches it, so the
+        // slot can go straight back to empty instead of leaving a tombstone
+        const size_t group = idx / group_width;
+        if (Group(ctrl_[group]).matchEmpty() != 0){
+            ctrlBytes()[idx] = ctrl_empty;
+            growth_left_++;
+        }else{
+            ctrlBytes()[idx] = ctrl_deleted;
+        }
+    }
+
+    // Smallest power of two capacity keeping count elements under a 7/8 load factor
+    static size_t capacityFor(size_t count){
+        return std::bit_ceil(std::max(group_width, count + count/7 + 1));
+    }
+
+    void rehash(size_t new_capacity){
+        CtrlGroup* old_ctrl  = ctrl_;
+        Value*     old_slots = slots_;
+        const size_t old_capacity = capacity_;
+
+        ctrl_     = CtrlTraits::allocate(ctrl_alloc_, new_capacity/group_width);
+        slots_    = ValueTraits::allocate(value_alloc_, new_capacity);
+        capacity_ = new_capacity;
+        size_     = 0;
+        resetCtrl();
+
+        const int8_t* old_bytes = reinterpret_cast<const int8_t*>(old_ctrl);
+        for (size_t idx = 0; idx < old_capacity; idx++){
+            if (old_bytes[idx] < 0) continue;
+            insertUnique(hashOf(KeyOf{}(old_slots[idx])), std::move(old_slots[idx]));
+            ValueTraits::destroy(value_alloc_, old_slots + idx);
+        }
+        if (old_capacity != 0){
+            CtrlTraits::deallocate(ctrl_alloc_, old_ctrl, old_capacity/group_width);
+            ValueTraits::deallocate(value_alloc_, old_slots, old_capacity);
+        }
+    }
+
+    void resetCtrl(){
+        std::memset(ctrl_, ctrl_empty, capacity_);
+        growth_left_ = capacity_ - capacity_/8 - size_;
+    }
+
+    void destroyAll(){
+        if constexpr (!std::is_trivially_destructible_v<Value>){
+            for (Value& value : *this) ValueTraits::destroy(value_alloc_, &value);
+        }
+    }
+
+    void release(){
+        if (capacity_ == 0) return;
+        CtrlTraits::deallocate(ctrl_alloc_, ctrl_, capacity_/group_width);
+        ValueTraits::deallocate(value_alloc_, slots_, capacity_);
+        ctrl_     = nullptr;
+        slots_    = nullptr;
+        capacity_ = 0;
+    }
+
+    int8_t*       ctrlBytes()       {return reinterpret_cast<int8_t*>(ctrl_);}
+    const int8_t* ctrlBytes() const {return reinterpret_cast<const int8_t*>(ctrl_);}
+
+    CtrlGroup* ctrl_    = nullptr;
+    Value*     slots_   = nullptr;
+    size_t capacity_    = 0;
+    size_t size_        = 0;
+    size_t growth_left_ = 0;
+    [[no_unique_address]] ValueAlloc value_alloc_;
+    [[no_unique_address]] CtrlAlloc  ctrl_alloc_;
+    [[no_unique_address]] Hasher     hash_;
+    [[no_unique_address]] KeyEqual   equal_;
+};
+
+struct PairFirst{
+    template<typename Pair>
+    const auto& operator()(const Pair& pair) const {return pair.first;}
+};
+
+struct Identity{
+    template<typename T>
+    const T& operator()(const T& value) const {return value;}
+};
+
+} // namespace detail
+
+// Keys are stored alongside their values as a mutable std::pair so the table can move
+// them when it grows. Never modify a key through an iterator
+template<typename Key, typename Value, typename Hasher = Hash<Key>, typename KeyEqual = std::equal_to<>,
+         typename Allocator = std::allocator<std::pair<Key, Value>>>
+class FlatHashMap : public detail::FlatTable<std::pair<Key, Value>, detail::PairFirst, Hasher, KeyEqual, Allocator>{
+    using Base = detail::FlatTable<std::pair<Key, Value>, detail::PairFirst, Hasher, KeyEqual, Allocator>;
+
+public:
+    using mapped_type = Value;
+    using typename Base::iterator;
+    using Base::Base;
+
+    FlatHashMap(std::initializer_list<std::pair<Key, Value>> values, const Allocator& alloc = Allocator()) : Base(values.size(), alloc) {
+        for (const auto& value : values) this->insert(value);
+    }
+
+    // Only constructs the key (and a value from args) if key isn't already present
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args){
+        return this->findOrInsert(key, [&]{
+            return std::pair<Key, Value>(std::piecewise_construct,
+                std::forward_as_tuple(std::forward<K>(key)),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+        });
+    }
+
+    template<typename K>
+    Value& operator[](K&& key){
+        return try_emplace(std::forward<K>(key)).first->second;
+    }
+
+    template<typename K>
+    Value& at(const K& key){
+        auto it = this->find(key);
+        if (it == this->end()) throw std::out_of_range("aoc::FlatHashMap::at");
+        return it->second;
+    }
+
+    template<typename K>
+    const Value& at(const K& key) const {
+        auto it = this->find(key);
+        if (it == this->end()) throw std::out_of_range("aoc::FlatHashMap::at");
+        return it->second;
+    }
+};
+
+template<typename Key, typename Hasher = Hash<Key>, typename KeyEqual = std::equal_to<>, typename Allocator = std::allocator<Key>>
+class FlatHashSet : public detail::FlatTable<Key, detail::Identity, Hasher, KeyEqual, Allocator>{
+    using Base = detail::FlatTable<Key, detail::Identity, Hasher, KeyEqual, Allocator>;
+
+public:
+    using Base::Base;
+
+    FlatHashSet(std::initializer_list<Key> keys, const Allocator& alloc = Allocator()) : Base(keys.size(), alloc) {
+        for (const Key& key : keys) this->insert(key);
+    }
+};
+
+// Versions that allocate from a std::pmr::memory_resource such as a monotonic arena
+namespace pmr{
+
+template<typename Key, typename Value, typename Hasher = Hash<Key>, typename KeyEqual = std::equal_to<>>
+using FlatHashMap = aoc::FlatHashMap<Key, Value, Hasher, KeyEqual, std::pmr::polymorphic_allocator<std::pair<Key, Value>>>;
+
+template<typename Key, typename Hasher = Hash<Key>, typename KeyEqual = std::equal_to<>>
+using FlatHashSet = aoc::FlatHashSet<Key, Hasher, KeyEqual, std::pmr::polymorphic_allocator<Key>>;
+
+} // namespace pmr
+
+} // namespace aoc
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <vector>
+#include <ranges>
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+
+// Contiguous row-major 2D grid surrounded by a border of sentinel cells. Any
+// cell reachable by a single step from the interior is a valid cell, so inner
+// loops can detect the edge by testing for the sentinel instead of bounds checking
+template<typename T>
+class Grid{
+public:
+    Grid() = default;
+
+    Grid(int width, int height, const T& fill, const T& sentinel, int border = 1) :
+        width_(width),
+        height_(height),
+        border_(border),
+        stride_(width + 2*border),
+        sentinel_(sentinel),
+        data_(static_cast<size_t>(stride_) * (height + 2*border), sentinel)
+    {
+        for (int y = 0; y < height_; y++){
+            std::ranges::fill(row(y), fill);
+        }
+    }
+
+    // Build a grid from newline separated text, converting each character with to_cell
+    template<typename F>
+    static Grid fromText(std::string_view text, const T& sentinel, F&& to_cell, int border = 1){
+        auto lines = text
+            | std::views::split('\n')
+            | std::views::filter([](auto line){return !line.empty();});
+        const int width  = std::ranges::empty(lines) ? 0 : std::ranges::distance(*lines.begin());
+        const int height = std::ranges::distance(lines);
+
+        Grid grid(width, height, sentinel, sentinel, border);
+        for (auto [y, line] : lines | std::views::enumerate){
+            std::ranges::transform(line | std::views::take(width), grid.row(y).begin(), to_cell);
+        }
+        return grid;
+    }
+
+    static Grid fromText(std::string_view text, const T& sentinel, int border = 1){
+        return fromText(text, sentinel, [](char c){return static_cast<T>(c);}, border);
+    }
+
+    int width()  const {return width_;}
+    int height() const {return height_;}
+    int border() const {return border_;}
+    const T& sentinel() const {return sentinel_;}
+
+    // Distance in cells between vertically adjacent cells
+    ptrdiff_t stride() const {return stride_;}
+
+    // Flat offset of interior coordinates, valid from -border to width/height + border - 1
+    ptrdiff_t offset(int x, int y) const {return static_cast<ptrdiff_t>(y + border_)*stride_ + x + border_;}
+    int x(ptrdiff_t offset) const {return static_cast<int>(offset % stride_) - border_;}
+    int y(ptrdiff_t offset) const {return static_cast<int>(offset / stride_) - border_;}
+
+    T&       operator()(int x, int y)       {return data_[offset(x, y)];}
+    const T& operator()(int x, int y) const {return data_[offset(x, y)];}
+    T&       operator[](ptrdiff_t offset)       {return data_[offset];}
+    const T& operator[](ptrdiff_t offset) const {return data_[offset];}
+
+    bool isSentinel(ptrdiff_t offset) const {return data_[offset] == sentinel_;}
+
+    // Offsets to the neighbouring cell in each direction
+    ptrdiff_t north() const {return -stride_;}
+    ptrdiff_t east()  const {return 1;}
+    ptrdiff_t south() const {return stride_;}
+    ptrdiff_t west()  const {return -1;}
+
+    // Neighbour offsets in north, east, south, west order
+    std::array<ptrdiff_t, 4> neighbourOffsets() const {return {north(), east(), south(), west()};}
+
+    // Interior cells of a single row
+    std::span<T>       row(int y)       {return {data_.data() + offset(0, y), static_cast<size_t>(width_)};}
+    std::span<const T> row(int y) const {return {data_.data() + offset(0, y), static_cast<size_t>(width_)};}
+
+    // Interior cells of a single column, as a strided view into the same storage
+    auto col(int x)       {return columnSpan(data_.data(), x) | std::views::stride(stride_);}
+    auto col(int x) const {return columnSpan(data_.data(), x) | std::views::stride(stride_);}
+
+    auto rows()       {return std::views::iota(0, height_) | std::views::transform([this](int y){return row(y);});}
+    auto rows() const {return std::views::iota(0, height_) | std::views::transform([this](int y){return row(y);});}
+    auto cols()       {return std::views::iota(0, width_)  | std::views::transform([this](int x){return col(x);});}
+    auto cols() const {return std::views::iota(0, width_)  | std::views::transform([this](int x){return col(x);});}
+
+    // All cells, border included
+    std::span<T>       data()       {return data_;}
+    std::span<const T> data() const {return data_;}
+
+    bool operator==(const Grid& other) const = default;
+
+private:
+    template<typename Ptr>
+    std::span<std::remove_pointer_t<Ptr>> columnSpan(Ptr base, int x) const {
+        if (height_ == 0) return {};
+        return {base + offset(x, 0), static_cast<size_t>(height_ - 1)*stride_ + 1};
+    }
+
+    int width_  = 0;
+    int height_ = 0;
+    int border_ = 0;
+    ptrdiff_t stride_ = 0;
+    T sentinel_{};
+    std::vector<T> data_;
+};
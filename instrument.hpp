@@ -0,0 +1,166 @@
+#pragma once
+
+// Scoped phase timers and event counters for the solvers. Everything here is
+// compiled away unless AOC_INSTRUMENT is defined (cmake -DAOC_INSTRUMENT=ON):
+//
+//     AOC_SCOPED_TIMER("solve");         // Time the rest of the enclosing scope
+//     AOC_COUNT("nodes_expanded", 1);    // Add to a named counter
+//     AOC_INSTRUMENT_REPORT(17, size);   // Emit one JSON record for this run
+
+#ifdef AOC_INSTRUMENT
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+namespace aoc::instrument{
+
+// Accumulated durations of every scope timed under one name
+struct Timer{
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> min_ns{UINT64_MAX};
+    std::atomic<uint64_t> max_ns{0};
+
+    void record(uint64_t ns){
+        count.fetch_add(1, std::memory_order_relaxed);
+        total_ns.fetch_add(ns, std::memory_order_relaxed);
+        for (uint64_t old = min_ns.load(std::memory_order_relaxed); ns < old && !min_ns.compare_exchange_weak(old, ns, std::memory_order_relaxed);)
+            ;
+        for (uint64_t old = max_ns.load(std::memory_order_relaxed); ns > old && !max_ns.compare_exchange_weak(old, ns, std::memory_order_relaxed);)
+            ;
+    }
+
+    void reset(){
+        count    = 0;
+        total_ns = 0;
+        min_ns   = UINT64_MAX;
+        max_ns   = 0;
+    }
+};
+
+struct Counter{
+    std::atomic<int64_t> value{0};
+
+    void add(int64_t n){
+        value.fetch_add(n, std::memory_order_relaxed);
+    }
+};
+
+// Process wide table of timers and counters. Entries are created on first use
+// and never removed, so call sites can cache references to them
+class Registry{
+public:
+    Timer& timer(std::string_view name){
+        std::lock_guard lock(mutex_);
+        auto& slot = timers_[std::string(name)];
+        if (!slot) slot = std::make_unique<Timer>();
+        return *slot;
+    }
+
+    Counter& counter(std::string_view name){
+        std::lock_guard lock(mutex_);
+        auto& slot = counters_[std::string(name)];
+        if (!slot) slot = std::make_unique<Counter>();
+        return *slot;
+    }
+
+    // Zero every entry so the next run starts from a clean slate
+    void reset(){
+        std::lock_guard lock(mutex_);
+        for (auto& [name, timer] : timers_) timer->reset();
+        for (auto& [name, counter] : counters_) counter->value = 0;
+    }
+
+    // Write a single line JSON record of everything recorded since the last reset
+    void writeJson(std::FILE* file, int day, size_t input_bytes) const {
+        std::lock_guard lock(mutex_);
+        std::fprintf(file, "{\"day\":%d,\"input_bytes\":%zu,\"timers\":{", day, input_bytes);
+        const char* separator = "";
+        for (const auto& [name, timer] : timers_){
+            const uint64_t count = timer->count.load();
+            if (count == 0) continue;
+            std::fprintf(file, "%s\"%s\":{\"count\":%llu,\"total_us\":%.3f,\"min_us\":%.3f,\"max_us\":%.3f}",
+                separator, name.c_str(),
+                static_cast<unsigned long long>(count),
+                timer->total_ns.load() / 1e3, timer->min_ns.load() / 1e3, timer->max_ns.load() / 1e3);
+            separator = ",";
+        }
+        std::fprintf(file, "},\"counters\":{");
+        separator = "";
+        for (const auto& [name, counter] : counters_){
+            std::fprintf(file, "%s\"%s\":%lld", separator, name.c_str(), static_cast<long long>(counter->value.load()));
+            separator = ",";
+        }
+        std::fprintf(file, "}}\n");
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<Timer>> timers_;
+    std::map<std::string, std::unique_ptr<Counter>> counters_;
+};
+
+inline Registry& registry(){
+    static Registry instance;
+    return instance;
+}
+
+class ScopedTimer{
+public:
+    explicit ScopedTimer(Timer& timer) : timer_(timer), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer(){
+        const auto stop = std::chrono::steady_clock::now();
+        timer_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start_).count());
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Timer& timer_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Append this run's record to the file named by AOC_INSTRUMENT_JSON, or stderr if unset
+inline void report(int day, size_t input_bytes){
+    const char* path = std::getenv("AOC_INSTRUMENT_JSON");
+    std::FILE* file = path ? std::fopen(path, "a") : stderr;
+    if (!file) return;
+    registry().writeJson(file, day, input_bytes);
+    if (file != stderr) std::fclose(file);
+}
+
+} // namespace aoc::instrument
+
+#define AOC_INSTRUMENT_CONCAT_IMPL(a, b) a##b
+#define AOC_INSTRUMENT_CONCAT(a, b) AOC_INSTRUMENT_CONCAT_IMPL(a, b)
+
+#define AOC_SCOPED_TIMER(name)                                                                        \
+    static aoc::instrument::Timer& AOC_INSTRUMENT_CONCAT(aoc_timer_ref_, __LINE__) =                 \
+        aoc::instrument::registry().timer(name);                                                      \
+    aoc::instrument::ScopedTimer AOC_INSTRUMENT_CONCAT(aoc_timer_, __LINE__)(AOC_INSTRUMENT_CONCAT(aoc_timer_ref_, __LINE__))
+
+#define AOC_COUNT(name, n)                                                                            \
+    do {                                                                                              \
+        static aoc::instrument::Counter& aoc_counter_ref = aoc::instrument::registry().counter(name); \
+        aoc_counter_ref.add(n);                                                                       \
+    } while (0)
+
+#define AOC_INSTRUMENT_RESET() aoc::instrument::registry().reset()
+#define AOC_INSTRUMENT_REPORT(day, input_bytes) aoc::instrument::report(day, input_bytes)
+
+#else
+
+#define AOC_SCOPED_TIMER(name) static_assert(true)
+#define AOC_COUNT(name, n) do {} while (0)
+#define AOC_INSTRUMENT_RESET() do {} while (0)
+#define AOC_INSTRUMENT_REPORT(day, input_bytes) do {} while (0)
+
+#endif
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <span>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+
+#include "thread_pool.hpp"
+
+namespace aoc{
+
+// Runs a function over every line of a text buffer on a ThreadPool. The buffer is cut
+// into chunks of whole lines about chunk_bytes long, so each task streams through a
+// cache sized piece of the input. Empty lines are skipped.
+//
+//     int64_t total = aoc::LineEngine{}.mapReduce(input, scoreLine, std::plus{});
+//
+// The calling thread works through chunks too, so an engine can be used from inside
+// a task already running on the same pool without deadlocking it
+class LineEngine{
+public:
+    static constexpr size_t default_chunk_bytes = 64 * 1024;
+    static constexpr size_t default_chunk_items = 1024;
+
+    explicit LineEngine(ThreadPool& pool = ThreadPool::shared(), size_t chunk_bytes = default_chunk_bytes) :
+        pool_(pool), chunk_bytes_(std::max<size_t>(chunk_bytes, 1)) {}
+
+    // Split buffer into consecutive pieces that each end just after a newline (or at the end of buffer)
+    std::vector<std::string_view> chunks(std::string_view buffer) const {
+        std::vector<std::string_view> pieces;
+        pieces.reserve(buffer.size()/chunk_bytes_ + 1);
+        while (!buffer.empty()){
+            const size_t newline = buffer.size() <= chunk_bytes_ ? std::string_view::npos : buffer.find('\n', chunk_bytes_);
+            const size_t end = newline == std::string_view::npos ? buffer.size() : newline + 1;
+            pieces.push_back(buffer.substr(0, end));
+            buffer.remove_prefix(end);
+        }
+        return pieces;
+    }
+
+    // Fold map_line(line) over every line with reduce, which must be associative and have
+    // a value initialised result as its identity. Chunk results are combined in input
+    // order, so reduce does not need to be commutative
+    template<typename Map, typename Reduce>
+    auto mapReduce(std::string_view buffer, Map&& map_line, Reduce&& reduce) const {
+        using Result = std::decay_t<std::invoke_result_t<Map&, std::string_view>>;
+        const std::vector<std::string_view> pieces = chunks(buffer);
+        std::vector<Result> partials(pieces.size());
+        forEachChunk(pieces.size(), [&](size_t idx){
+            Result partial{};
+            forEachLine(pieces[idx], [&](std::string_view line){
+                partial = std::invoke(reduce, std::move(partial), std::invoke(map_line, line));
+            });
+            partials[idx] = std::move(partial);
+        });
+
+        Result total{};
+        for (Result& partial : partials) total = std::invoke(reduce, std::move(total), std::move(partial));
+        return total;
+    }
+
+    // Like mapReduce, but map_chunk is handed whole chunks of lines, for kernels that
+    // work on many lines at once
+    template<typename Map, typename Reduce>
+    auto mapReduceChunks(std::string_view buffer, Map&& map_chunk, Reduce&& reduce) const {
+        using Result = std::decay_t<std::invoke_result_t<Map&, std::string_view>>;
+        const std::vector<std::string_view> pieces = chunks(buffer);
+        std::vector<Result> partials(pieces.size());
+        forEachChunk(pieces.size(), [&](size_t idx){
+            partials[idx] = std::invoke(map_chunk, pieces[idx]);
+        });
+
+        Result total{};
+        for (Result& partial : partials) total = std::invoke(reduce, std::move(total), std::move(partial));
+        return total;
+    }
+
+    // Like mapReduce, but over items parsed earlier instead of lines. The items are handed
+    // out chunk_items at a time, which should be small when each item is a lot of work
+    template<typename T, typename Map, typename Reduce>
+    auto mapReduceItems(std::span<T> items, Map&& map_item, Reduce&& reduce, size_t chunk_items = default_chunk_items) const {
+        using Result = std::decay_t<std::invoke_result_t<Map&, T&>>;
+        chunk_items = std::max<size_t>(chunk_items, 1);
+        const size_t num_chunks = (items.size() + chunk_items - 1) / chunk_items;
+        std::vector<Result> partials(num_chunks);
+        forEachChunk(num_chunks, [&](size_t idx){
+            Result partial{};
+            for (T& item : items.subspan(idx*chunk_items, std::min(chunk_items, items.size() - idx*chunk_items))){
+                partial = std::invoke(reduce, std::move(partial), std::invoke(map_item, item));
+            }
+            partials[idx] = std::move(partial);
+        });
+
+        Result total{};
+        for (Result& partial : partials) total = std::invoke(reduce, std::move(total), std::move(partial));
+        return total;
+    }
+
+    // map_line(line) of every line, in input order
+    template<typename Map>
+    auto mapLines(std::string_view buffer, Map&& map_line) const {
+        using Result = std::decay_t<std::invoke_result_t<Map&, std::string_view>>;
+        const std::vector<std::string_view> pieces = chunks(buffer);
+        std::vector<std::vector<Result>> partials(pieces.size());
+        forEachChunk(pieces.size(), [&](size_t idx){
+            forEachLine(pieces[idx], [&](std::string_view line){
+                partials[idx].push_back(std::invoke(map_line, line));
+            });
+        });
+
+        size_t count = 0;
+        for (const auto& partial : partials) count += partial.size();
+        std::vector<Result> results;
+        results.reserve(count);
+        for (auto& partial : partials) std::ranges::move(partial, std::back_inserter(results));
+        return results;
+    }
+
+private:
+    template<typename F>
+    static void forEachLine(std::string_view chunk, F&& process_line){
+        while (!chunk.empty()){
+            const size_t end = std::min(chunk.find('\n'), chunk.size());
+            if (end != 0) process_line(chunk.substr(0, end));
+            chunk.remove_prefix(std::min(end + 1, chunk.size()));
+        }
+    }
+
+    // Call process(idx) for every idx in [0, count) across the pool and the calling thread
+    template<typename F>
+    void forEachChunk(size_t count, F&& process) const {
+        if (count <= 1 || pool_.size() == 0){
+            for (size_t idx = 0; idx < count; idx++) process(idx);
+            return;
+        }
+
+        // Helpers can be dequeued after every chunk has been claimed and this call has
+        // returned, so the bookkeeping they touch is kept alive by the helpers themselves
+        struct Progress{
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            std::mutex error_mutex;
+            std::exception_ptr error;
+        };
+        auto progress = std::make_shared<Progress>();
+        auto work = [progress, count, &process]{
+            for (size_t idx; (idx = progress->next.fetch_add(1, std::memory_order_relaxed)) < count;){
+                try{
+                    process(idx);
+                }catch (...){
+                    std::lock_guard lock(progress->error_mutex);
+                    if (!progress->error) progress->error = std::current_exception();
+                }
+                if (progress->done.fetch_add(1, std::memory_order_acq_rel) + 1 == count) progress->done.notify_all();
+            }
+        };
+
+        const size_t num_helpers = std::min(pool_.size(), count - 1);
+        for (size_t i = 0; i < num_helpers; i++) pool_.post(work);
+        work();
+        for (size_t done = progress->done.load(std::memory_order_acquire); done != count; done = progress->done.load(std::memory_order_acquire)){
+            progress->done.wait(done, std::memory_order_acquire);
+        }
+
+        if (progress->error) std::rethrow_exception(progress->error);
+    }
+
+    ThreadPool& pool_;
+    size_t chunk_bytes_;
+};
+
+} // namespace aoc
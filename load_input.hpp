@@ -1,10 +1,109 @@
-#include <fstream>
+#pragma once
+
+#include <span>
 #include <string>
+#include <fstream>
 #include <sstream>
+#include <utility>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 static inline std::string loadInput(const std::string& filename){
     std::ifstream text_file(filename);
     std::stringstream ss;
     ss << text_file.rdbuf();
     return ss.str();
-}
\ No newline at end of file
+}
+
+// How the file pages are mapped into memory
+enum class MapMode{
+    READ_ONLY,     // Shared read-only pages, writing through the mapping is an error
+    COPY_ON_WRITE  // Private writable pages, edits never reach the file on disk
+};
+
+// Memory mapped view of an input file. The file contents are never copied into
+// a std::string, and the object can be used anywhere the loadInput() string was
+// used as a range of characters (e.g. input | views::split('\n'))
+class MappedInput{
+public:
+    MappedInput() = default;
+
+    MappedInput(const std::string& filename, MapMode mode = MapMode::READ_ONLY, bool populate = true) :
+        mode_(mode)
+    {
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+
+        // Like loadInput, a missing or empty file is just an empty input
+        struct stat file_stat{};
+        if (::fstat(fd, &file_stat) == 0 && file_stat.st_size > 0){
+            const int prot  = mode == MapMode::READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+            const int flags = (mode == MapMode::READ_ONLY ? MAP_SHARED : MAP_PRIVATE) | (populate ? MAP_POPULATE : 0);
+            void* addr = ::mmap(nullptr, file_stat.st_size, prot, flags, fd, 0);
+            if (addr != MAP_FAILED){
+                data_ = static_cast<char*>(addr);
+                size_ = static_cast<size_t>(file_stat.st_size);
+                ::madvise(addr, size_, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+    }
+
+    MappedInput(const MappedInput&) = delete;
+    MappedInput& operator=(const MappedInput&) = delete;
+
+    MappedInput(MappedInput&& other) noexcept :
+        data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        mode_(other.mode_)
+    {}
+
+    MappedInput& operator=(MappedInput&& other) noexcept {
+        if (this != &other){
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            mode_ = other.mode_;
+        }
+        return *this;
+    }
+
+    ~MappedInput(){
+        unmap();
+    }
+
+    // Read-only access
+    std::string_view view() const {return {data_, size_};}
+    operator std::string_view() const {return view();}
+    const char* begin() const {return data_;}
+    const char* end()   const {return data_ + size_;}
+
+    // Mutable access, only valid for COPY_ON_WRITE mappings
+    std::span<char> span() {return {data_, size_};}
+    char* begin() {return data_;}
+    char* end()   {return data_ + size_;}
+
+    const char* data() const {return data_;}
+    size_t size() const {return size_;}
+    bool empty() const {return size_ == 0;}
+    MapMode mode() const {return mode_;}
+
+private:
+    void unmap(){
+        if (data_) ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    char* data_  = nullptr;
+    size_t size_ = 0;
+    MapMode mode_ = MapMode::READ_ONLY;
+};
+
+static inline MappedInput mapInput(const std::string& filename, MapMode mode = MapMode::READ_ONLY){
+    return MappedInput(filename, mode);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+// Leveled diagnostics for the solvers. Logging is off unless AOC_LOG_LEVEL is set
+// (error, warn, info, debug or trace), and a disabled message costs one relaxed
+// load, its arguments are never formatted:
+//
+//     AOC_LOG(DEBUG, "Starting seed range {}", idx);
+//
+// Messages are appended to a shared buffer that is written out when it fills, on
+// flush() and at exit, so solver threads never wait on the terminal. Output goes to
+// the file named by AOC_LOG_FILE, or stderr when it is unset
+
+#include <mutex>
+#include <atomic>
+#include <cstdio>
+#include <format>
+#include <string>
+#include <cstdlib>
+#include <utility>
+#include <string_view>
+
+namespace aoc::log{
+
+enum class Level{
+    OFF,
+    ERROR,
+    WARN,
+    INFO,
+    DEBUG,
+    TRACE
+};
+
+static constexpr std::string_view level_names[]{"off", "error", "warn", "info", "debug", "trace"};
+
+inline Level levelFromName(std::string_view name){
+    for (size_t idx = 0; idx < std::size(level_names); idx++){
+        if (name == level_names[idx]) return static_cast<Level>(idx);
+    }
+    return Level::OFF;
+}
+
+// Buffered, thread safe destination for every message
+class Sink{
+public:
+    static constexpr size_t flush_bytes = 64 * 1024;
+
+    Sink(){
+        const char* path = std::getenv("AOC_LOG_FILE");
+        file_ = path ? std::fopen(path, "a") : nullptr;
+        if (!file_) file_ = stderr;
+    }
+
+    ~Sink(){
+        flush();
+        if (file_ != stderr) std::fclose(file_);
+    }
+
+    Sink(const Sink&) = delete;
+    Sink& operator=(const Sink&) = delete;
+
+    void write(Level level, std::string_view message){
+        std::lock_guard lock(mutex_);
+        buffer_ += '[';
+        buffer_ += level_names[static_cast<size_t>(level)];
+        buffer_ += "] ";
+        buffer_ += message;
+        buffer_ += '\n';
+        if (buffer_.size() >= flush_bytes) flushLocked();
+    }
+
+    void flush(){
+        std::lock_guard lock(mutex_);
+        flushLocked();
+    }
+
+private:
+    void flushLocked(){
+        if (buffer_.empty()) return;
+        std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+        std::fflush(file_);
+        buffer_.clear();
+    }
+
+    std::mutex mutex_;
+    std::string buffer_;
+    std::FILE* file_ = nullptr;
+};
+
+inline Sink& sink(){
+    static Sink instance;
+    return instance;
+}
+
+inline std::atomic<Level>& currentLevel(){
+    static std::atomic<Level> level{[]{
+        const char* name = std::getenv("AOC_LOG_LEVEL");
+        return name ? levelFromName(name) : Level::OFF;
+    }()};
+    return level;
+}
+
+inline bool enabled(Level level){
+    return level != Level::OFF && level <= currentLevel().load(std::memory_order_relaxed);
+}
+
+inline void setLevel(Level level){
+    currentLevel().store(level, std::memory_order_relaxed);
+}
+
+template<typename... Args>
+void write(Level level, std::format_string<Args...> fmt, Args&&... args){
+    sink().write(level, std::format(fmt, std::forward<Args>(args)...));
+}
+
+inline void flush(){
+    sink().flush();
+}
+
+} // namespace aoc::log
+
+#define AOC_LOG(level, ...)                                                        \
+    do {                                                                           \
+        if (aoc::log::enabled(aoc::log::Level::level))                             \
+            aoc::log::write(aoc::log::Level::level, __VA_ARGS__);                  \
+    } while (0)
@@ -0,0 +1,105 @@
+#pragma once
+
+// Heap and resident memory accounting. Configuring with -DAOC_MEMORY_PROFILE=ON links in
+// tools/memory_hooks.cpp, which replaces the global operator new and delete with versions
+// that count every allocation. Without it the counters stay at zero and enabled is false:
+//
+//     aoc::memory::PhaseUsage usage = aoc::memory::measure([&]{ parsed = parse(input); });
+//
+// Peak RSS comes from VmHWM in /proc/self/status, which is reset through
+// /proc/self/clear_refs at the start of a phase where the kernel allows it
+
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+namespace aoc::memory{
+
+#ifdef AOC_MEMORY_PROFILE
+inline constexpr bool enabled = true;
+#else
+inline constexpr bool enabled = false;
+#endif
+
+// Process wide totals, updated by the allocation hooks
+struct Counters{
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> deallocations{0};
+    std::atomic<uint64_t> allocated_bytes{0};
+    std::atomic<int64_t> live_bytes{0};
+    std::atomic<int64_t> peak_live_bytes{0};
+
+    void recordAlloc(size_t bytes){
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        const int64_t live = live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        for (int64_t old = peak_live_bytes.load(std::memory_order_relaxed); live > old && !peak_live_bytes.compare_exchange_weak(old, live, std::memory_order_relaxed);)
+            ;
+    }
+
+    void recordFree(size_t bytes){
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+};
+
+inline Counters& counters(){
+    static constinit Counters instance;
+    return instance;
+}
+
+// Largest resident set size of the process so far, in bytes, or 0 if it can't be read
+inline uint64_t peakRss(){
+    std::FILE* file = std::fopen("/proc/self/status", "r");
+    if (!file) return 0;
+    char line[256];
+    uint64_t kib = 0;
+    while (std::fgets(line, sizeof(line), file)){
+        if (std::strncmp(line, "VmHWM:", 6) == 0){
+            std::sscanf(line + 6, "%lu", &kib);
+            break;
+        }
+    }
+    std::fclose(file);
+    return kib * 1024;
+}
+
+// Bring the peak RSS back down to the current RSS. Returns false when the kernel refuses
+inline bool resetPeakRss(){
+    std::FILE* file = std::fopen("/proc/self/clear_refs", "w");
+    if (!file) return false;
+    const bool ok = std::fputs("5", file) >= 0;
+    return (std::fclose(file) == 0) && ok;
+}
+
+// What one phase allocated. Peak heap is the high water mark above the heap in use when
+// the phase began, so memory the phase frees again still shows up
+struct PhaseUsage{
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    int64_t peak_heap_bytes = 0;
+    uint64_t peak_rss_bytes = 0;
+};
+
+// Run phase and record its allocations. Only meaningful while nothing else is allocating
+template<typename F>
+PhaseUsage measure(F&& phase){
+    Counters& totals = counters();
+    resetPeakRss();
+    const int64_t live_before = totals.live_bytes.load(std::memory_order_relaxed);
+    totals.peak_live_bytes.store(live_before, std::memory_order_relaxed);
+    const uint64_t allocations_before = totals.allocations.load(std::memory_order_relaxed);
+    const uint64_t bytes_before = totals.allocated_bytes.load(std::memory_order_relaxed);
+
+    phase();
+
+    return PhaseUsage{
+        .allocations     = totals.allocations.load(std::memory_order_relaxed) - allocations_before,
+        .allocated_bytes = totals.allocated_bytes.load(std::memory_order_relaxed) - bytes_before,
+        .peak_heap_bytes = totals.peak_live_bytes.load(std::memory_order_relaxed) - live_before,
+        .peak_rss_bytes  = peakRss()
+    };
+}
+
+} // namespace aoc::memory
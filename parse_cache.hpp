@@ -0,0 +1,264 @@
+#pragma once
+
+// Binary cache of a day's parsed data. When a cache directory is set (AOC_PARSE_CACHE or
+// setDirectory()), the first parse of an input stores the day's structures as flat arrays
+// in DIR/dayN_<hash>.bin, keyed by a hash of the input's contents. Later runs on the same
+// input map that file and copy the arrays straight back out instead of parsing text.
+//
+// A day opts in by handing makeSolver() a CacheIO with its save and load functions. Any
+// mismatch (format or schema version, input hash or size, truncation) just means a normal
+// parse, and the cache file is rewritten
+
+#include <bit>
+#include <span>
+#include <array>
+#include <ranges>
+#include <cstdio>
+#include <format>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <concepts>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+#include <string_view>
+#include <type_traits>
+
+#include <unistd.h>
+
+#include "load_input.hpp"
+#include "instrument.hpp"
+
+namespace aoc::cache{
+
+// Bumped whenever the header or array encoding changes. Days bump their own schema version
+// in CacheIO when the layout of their payload changes
+static constexpr uint32_t format_version = 1;
+static constexpr std::array<char, 8> magic{'A', 'O', 'C', 'P', 'A', 'R', 'S', 'E'};
+
+struct Header{
+    std::array<char, 8> magic;
+    uint32_t format_version;
+    uint32_t day;
+    uint32_t schema_version;
+    uint32_t reserved;
+    uint64_t input_hash;
+    uint64_t input_bytes;
+    uint64_t payload_bytes;
+};
+
+// Arrays are padded to this so every element read starts suitably aligned
+static constexpr size_t array_alignment = 8;
+
+template<typename T>
+concept Storable = std::is_trivially_copyable_v<T> && std::default_initializable<T> && alignof(T) <= array_alignment;
+
+// Fast 64 bit hash of the input, reading four independent 8 byte lanes at a time
+inline uint64_t contentHash(std::string_view data){
+    constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    auto load = [](const char* p){uint64_t v; std::memcpy(&v, p, sizeof(v)); return v;};
+    auto round = [](uint64_t acc, uint64_t lane){return std::rotl(acc + lane*prime2, 31) * prime1;};
+
+    std::array<uint64_t, 4> acc{prime1 + prime2, prime2, 0, 0 - prime1};
+    const char* p   = data.data();
+    const char* end = p + data.size();
+    for (; end - p >= 32; p += 32){
+        for (size_t lane = 0; lane < 4; lane++) acc[lane] = round(acc[lane], load(p + 8*lane));
+    }
+
+    uint64_t hash = std::rotl(acc[0], 1) + std::rotl(acc[1], 7) + std::rotl(acc[2], 12) + std::rotl(acc[3], 18);
+    hash += data.size();
+    for (; end - p >= 8; p += 8) hash = std::rotl(hash ^ round(0, load(p)), 27) * prime1;
+    for (; p < end; p++) hash = std::rotl(hash ^ (static_cast<uint8_t>(*p) * prime1), 11) * prime2;
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+// Piece of the input text, stored as offsets so it can be turned back into a view of the
+// same input on a later run
+struct TextRef{
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+inline TextRef ref(std::string_view input, std::string_view piece){
+    return TextRef{.offset = static_cast<uint64_t>(piece.data() - input.data()), .length = piece.size()};
+}
+
+inline std::string_view deref(std::string_view input, TextRef text){
+    if (text.offset > input.size() || text.length > input.size() - text.offset) throw std::runtime_error("aoc::cache: text reference outside the input");
+    return input.substr(text.offset, text.length);
+}
+
+// Builds a cache payload out of single values and length prefixed arrays
+class Writer{
+public:
+    template<Storable T>
+    void write(const T& value){
+        append(&value, sizeof(T));
+        pad();
+    }
+
+    template<std::ranges::contiguous_range R> requires Storable<std::ranges::range_value_t<R>>
+    void writeArray(const R& values){
+        write(static_cast<uint64_t>(std::ranges::size(values)));
+        append(std::ranges::data(values), std::ranges::size(values) * sizeof(std::ranges::range_value_t<R>));
+        pad();
+    }
+
+    const std::string& bytes() const {return bytes_;}
+
+private:
+    void append(const void* data, size_t size){
+        bytes_.append(static_cast<const char*>(data), size);
+    }
+
+    void pad(){
+        bytes_.resize((bytes_.size() + array_alignment - 1) / array_alignment * array_alignment, '\0');
+    }
+
+    std::string bytes_;
+};
+
+// Reads a payload back in the order it was written. Running past the end throws, which
+// the caller treats as a stale cache
+class Reader{
+public:
+    explicit Reader(std::string_view payload) : payload_(payload) {}
+
+    template<Storable T>
+    T read(){
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template<Storable T>
+    std::vector<T> readArray(){
+        std::vector<T> values;
+        readArray(values);
+        return values;
+    }
+
+    // Replace the contents of values, keeping its allocator
+    template<Storable T, typename Allocator>
+    void readArray(std::vector<T, Allocator>& values){
+        const uint64_t count = read<uint64_t>();
+        if (count > payload_.size() / sizeof(T)) throw std::runtime_error("aoc::cache: array longer than the payload");
+        values.resize(count);
+        const char* data = take(count * sizeof(T));
+        if (count != 0) std::memcpy(values.data(), data, count * sizeof(T));
+    }
+
+    bool done() const {return pos_ == payload_.size();}
+
+private:
+    const char* take(size_t size){
+        if (size > payload_.size() - pos_) throw std::runtime_error("aoc::cache: payload is truncated");
+        const char* data = payload_.data() + pos_;
+        pos_ += (size + array_alignment - 1) / array_alignment * array_alignment;
+        pos_ = std::min(pos_, payload_.size());
+        return data;
+    }
+
+    std::string_view payload_;
+    size_t pos_ = 0;
+};
+
+// How a day stores its Parsed data. Text is saved as TextRefs into input rather than copied
+template<typename Parsed>
+struct CacheIO{
+    uint32_t schema_version;
+    void (*save)(const Parsed& parsed, std::string_view input, Writer& writer);
+    Parsed (*load)(Reader& reader, std::string_view input);
+};
+
+inline std::filesystem::path& directoryStorage(){
+    static std::filesystem::path directory = []{
+        const char* env = std::getenv("AOC_PARSE_CACHE");
+        return env ? std::filesystem::path(env) : std::filesystem::path();
+    }();
+    return directory;
+}
+
+// Where cache files live, empty when caching is off
+inline const std::filesystem::path& directory(){
+    return directoryStorage();
+}
+
+inline void setDirectory(std::filesystem::path dir){
+    directoryStorage() = std::move(dir);
+}
+
+inline std::filesystem::path cachePath(int day, uint64_t input_hash){
+    return directory() / std::format("day{}_{:016x}.bin", day, input_hash);
+}
+
+// Write to a temporary file and rename it into place, so concurrent runs never see half a file
+inline bool store(const std::filesystem::path& path, const Header& header, const std::string& payload){
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    const std::filesystem::path temp_path = path.string() + ".tmp" + std::to_string(::getpid());
+
+    std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+           && std::fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+    ok = (std::fclose(file) == 0) && ok;
+    if (ok) std::filesystem::rename(temp_path, path, ec);
+    if (!ok || ec) std::filesystem::remove(temp_path, ec);
+    return ok && !ec;
+}
+
+// Parse input through the cache when one is configured
+template<typename Parsed>
+Parsed parseCached(int day, std::string_view input, Parsed(*parse)(std::string_view), const CacheIO<Parsed>& io){
+    if (directory().empty()) return parse(input);
+
+    const uint64_t input_hash = contentHash(input);
+    const std::filesystem::path path = cachePath(day, input_hash);
+    if (MappedInput cached(path.string()); cached.size() >= sizeof(Header)){
+        Header header;
+        std::memcpy(&header, cached.data(), sizeof(header));
+        const std::string_view payload = cached.view().substr(sizeof(Header));
+        if (header.magic == magic && header.format_version == format_version && header.day == static_cast<uint32_t>(day)
+            && header.schema_version == io.schema_version && header.input_hash == input_hash
+            && header.input_bytes == input.size() && header.payload_bytes == payload.size())
+        {
+            try{
+                Reader reader(payload);
+                Parsed parsed = io.load(reader, input);
+                AOC_COUNT("parse_cache_hits", 1);
+                return parsed;
+            }catch (const std::exception&){
+                // Fall through and rebuild the cache from the text
+            }
+        }
+    }
+
+    AOC_COUNT("parse_cache_misses", 1);
+    Parsed parsed = parse(input);
+    Writer writer;
+    io.save(parsed, input, writer);
+    const Header header{
+        .magic          = magic,
+        .format_version = format_version,
+        .day            = static_cast<uint32_t>(day),
+        .schema_version = io.schema_version,
+        .reserved       = 0,
+        .input_hash     = input_hash,
+        .input_bytes    = input.size(),
+        .payload_bytes  = writer.bytes().size()
+    };
+    store(path, header, writer.bytes());
+    return parsed;
+}
+
+} // namespace aoc::cache
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <bit>
+#include <span>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <concepts>
+#include <string_view>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Allocation free integer parsing for the solvers. Digits are located 64 bytes
+// at a time with vector compares (AVX2, or SSE2 which covers every SSE4 target,
+// with a scalar fallback) and runs of up to 8 digits are converted with SWAR
+// arithmetic instead of a multiply per character. The input never needs to be
+// null terminated, so these are safe to use directly on a MappedInput
+
+namespace aoc{
+
+namespace detail{
+
+// Bit i is set when p[i] is a decimal digit, bytes at or past n count as non-digits
+inline uint64_t digitMask64(const char* p, size_t n){
+    alignas(64) char padded[64];
+    if (n < 64){
+        std::memset(padded, 0, sizeof(padded));
+        std::memcpy(padded, p, n);
+        p = padded;
+    }
+
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    auto mask32 = [&](const char* q) -> uint64_t {
+        const __m256i offset = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(q)), zero);
+        const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_max_epu8(offset, nine), nine);
+        return static_cast<uint32_t>(_mm256_movemask_epi8(is_digit));
+    };
+    return mask32(p) | (mask32(p + 32) << 32);
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    auto mask16 = [&](const char* q) -> uint64_t {
+        const __m128i offset = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(q)), zero);
+        const __m128i is_digit = _mm_cmpeq_epi8(_mm_max_epu8(offset, nine), nine);
+        return static_cast<uint16_t>(_mm_movemask_epi8(is_digit));
+    };
+    return mask16(p) | (mask16(p + 16) << 16) | (mask16(p + 32) << 32) | (mask16(p + 48) << 48);
+#else
+    uint64_t mask = 0;
+    for (int idx = 0; idx < 64; idx++){
+        mask |= static_cast<uint64_t>(static_cast<unsigned char>(p[idx] - '0') <= 9) << idx;
+    }
+    return mask;
+#endif
+}
+
+// Bit i is set when p[i] == c, bytes at or past n never match
+inline uint64_t byteMask64(const char* p, size_t n, char c){
+    alignas(64) char padded[64];
+    if (n < 64){
+        std::memset(padded, c + 1, sizeof(padded));
+        std::memcpy(padded, p, n);
+        p = padded;
+    }
+
+#if defined(__AVX2__)
+    const __m256i target = _mm256_set1_epi8(c);
+    auto mask32 = [&](const char* q) -> uint64_t {
+        const __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(q)), target);
+        return static_cast<uint32_t>(_mm256_movemask_epi8(equal));
+    };
+    return mask32(p) | (mask32(p + 32) << 32);
+#elif defined(__SSE2__)
+    const __m128i target = _mm_set1_epi8(c);
+    auto mask16 = [&](const char* q) -> uint64_t {
+        const __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(q)), target);
+        return static_cast<uint16_t>(_mm_movemask_epi8(equal));
+    };
+    return mask16(p) | (mask16(p + 16) << 16) | (mask16(p + 32) << 32) | (mask16(p + 48) << 48);
+#else
+    uint64_t mask = 0;
+    for (int idx = 0; idx < 64; idx++){
+        mask |= static_cast<uint64_t>(p[idx] == c) << idx;
+    }
+    return mask;
+#endif
+}
+
+// Load up to 8 bytes without reading past end, the first character ends up in the lowest byte
+inline uint64_t load8(const char* p, const char* end){
+    uint64_t chunk = 0;
+    std::memcpy(&chunk, p, end - p >= 8 ? 8 : end - p);
+    return chunk;
+}
+
+// Value of len (1 to 8) decimal digits at p
+inline uint64_t swarDecimal(const char* p, size_t len, const char* end){
+    // Subtracting first only borrows out of the non-digit bytes, which get shifted out next
+    uint64_t chunk = load8(p, end) - 0x3030303030303030ull;
+    chunk <<= 8*(8 - len);
+    chunk = ((chunk & 0x000F000F000F000Full) * 10)    + ((chunk >> 8)  & 0x000F000F000F000Full);
+    chunk = ((chunk & 0x000000FF000000FFull) * 100)   + ((chunk >> 16) & 0x000000FF000000FFull);
+    chunk = ((chunk & 0x000000000000FFFFull) * 10000) + ((chunk >> 32) & 0x000000000000FFFFull);
+    return chunk;
+}
+
+// Value of len (1 to 8) hex digits at p, either case
+inline uint64_t swarHex(const char* p, size_t len, const char* end){
+    uint64_t chunk = load8(p, end);
+    chunk = (chunk & 0x0F0F0F0F0F0F0F0Full) + 9*((chunk >> 6) & 0x0101010101010101ull);
+    chunk <<= 8*(8 - len);
+    chunk = ((chunk & 0x000F000F000F000Full) << 4)  | ((chunk >> 8)  & 0x000F000F000F000Full);
+    chunk = ((chunk & 0x000000FF000000FFull) << 8)  | ((chunk >> 16) & 0x000000FF000000FFull);
+    chunk = ((chunk & 0x000000000000FFFFull) << 16) | ((chunk >> 32) & 0x000000000000FFFFull);
+    return chunk;
+}
+
+inline uint64_t parseDigitRun(const char* p, size_t len, const char* end){
+    static constexpr std::array<uint64_t, 9> powers{1, 10, 100, 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000};
+    uint64_t value = 0;
+    for (; len > 8; p += 8, len -= 8){
+        value = value*powers[8] + swarDecimal(p, 8, end);
+    }
+    return value*powers[len] + swarDecimal(p, len, end);
+}
+
+inline bool isHexDigit(char c){
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+} // namespace detail
+
+// Parse every integer in str into out and return how many were written. Any
+// non-digit characters separate the fields, and a '-' directly before a field
+// makes it negative. Parsing stops early once out is full
+template<std::integral Int>
+size_t parseIntegers(std::string_view str, std::span<Int> out){
+    const char* const begin = str.data();
+    const char* const end   = begin + str.size();
+
+    size_t count  = 0;
+    size_t resume = 0;
+    for (size_t block = 0; block < str.size() && count < out.size(); block += 64){
+        // Skip digits belonging to a number that started in an earlier block
+        if (resume >= block + 64) continue;
+        uint64_t digits = detail::digitMask64(begin + block, str.size() - block);
+        if (resume > block) digits &= ~0ull << (resume - block);
+
+        while (digits != 0 && count < out.size()){
+            const size_t start = std::countr_zero(digits);
+            const uint64_t run = ~(digits >> start);
+            size_t len = run == 0 ? 64 - start : std::countr_zero(run);
+
+            // A run touching the end of the block may carry on into the next one
+            const char* num = begin + block + start;
+            if (start + len == 64){
+                while (num + len < end && static_cast<unsigned char>(num[len] - '0') <= 9) len++;
+            }
+
+            const uint64_t value = detail::parseDigitRun(num, len, end);
+            const bool negative  = std::is_signed_v<Int> && num > begin && num[-1] == '-';
+            out[count++] = negative ? -static_cast<Int>(value) : static_cast<Int>(value);
+
+            resume = block + start + len;
+            digits = resume - block >= 64 ? 0 : digits & (~0ull << (resume - block));
+        }
+    }
+    return count;
+}
+
+// Parse the first integer in str, or zero if there is none
+template<std::integral Int>
+Int parseInteger(std::string_view str){
+    Int value{};
+    parseIntegers(str, std::span<Int>(&value, 1));
+    return value;
+}
+
+// Parse the hex digits at the start of str, stopping at the first non-hex character
+inline uint64_t parseHex(std::string_view str){
+    const char* p   = str.data();
+    const char* end = p + str.size();
+    size_t len = 0;
+    while (len < 16 && p + len < end && detail::isHexDigit(p[len])) len++;
+
+    uint64_t value = 0;
+    for (; len > 8; p += 8, len -= 8){
+        value = (value << 32) | detail::swarHex(p, 8, end);
+    }
+    return len == 0 ? value : (value << 4*len) | detail::swarHex(p, len, end);
+}
+
+} // namespace aoc
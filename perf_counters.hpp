@@ -0,0 +1,162 @@
+#pragma once
+
+// Hardware performance counters through Linux perf_event_open. Counts are kept per thread
+// and summed on read. Every counter is opened with inherit set, and reading an inherited
+// counter also adds in the live threads spawned after it was opened. Threads that already
+// exist, such as the thread pool's workers, are not covered and have to be added by id, so
+// a pool has to be started before the counters are opened or its workers count twice:
+//
+//     aoc::ThreadPool& pool = aoc::ThreadPool::shared();
+//     aoc::perf::Counters counters;
+//     pool.runOnEachWorker([&]{ ids.push_back(aoc::perf::currentThreadId()); });
+//     for (pid_t id : ids) counters.addThread(id);
+//     aoc::perf::Sample before = counters.read();
+//     ...
+//     aoc::perf::Sample used = counters.read() - before;
+//
+// Events the kernel or CPU refuses (no PMU in a VM, perf_event_paranoid, other OSes) are
+// reported as unavailable, and so is an event that could not be opened on every thread.
+// Counts are scaled up when the kernel had to multiplex them
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace aoc::perf{
+
+enum Event{
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    NUM_EVENTS
+};
+
+static constexpr std::array<std::string_view, NUM_EVENTS> event_names{"cycles", "instructions", "L1D misses", "LLC misses", "branch misses"};
+
+struct Sample{
+    std::array<double, NUM_EVENTS> values{};
+    std::array<bool, NUM_EVENTS> available{};
+
+    bool has(Event event) const {return available[event];}
+    double operator[](Event event) const {return values[event];}
+
+    Sample operator-(const Sample& other) const {
+        Sample result = *this;
+        for (size_t idx = 0; idx < NUM_EVENTS; idx++) result.values[idx] -= other.values[idx];
+        return result;
+    }
+
+    Sample& operator+=(const Sample& other){
+        for (size_t idx = 0; idx < NUM_EVENTS; idx++) values[idx] += other.values[idx];
+        return *this;
+    }
+
+    // Instructions per cycle, or 0 when either counter is missing
+    double ipc() const {
+        return has(CYCLES) && has(INSTRUCTIONS) && values[CYCLES] > 0 ? values[INSTRUCTIONS] / values[CYCLES] : 0.0;
+    }
+};
+
+#ifdef __linux__
+inline pid_t currentThreadId(){
+    return static_cast<pid_t>(::syscall(SYS_gettid));
+}
+#endif
+
+class Counters{
+public:
+    // Counts the calling thread
+    Counters(){
+#ifdef __linux__
+        addThread(0);
+#endif
+    }
+
+    ~Counters(){
+#ifdef __linux__
+        for (const auto& fds : threads_) for (int fd : fds) if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    Counters(const Counters&) = delete;
+    Counters& operator=(const Counters&) = delete;
+
+#ifdef __linux__
+    // Count another thread of this process as well, by its kernel thread id
+    void addThread(pid_t thread_id){
+        std::array<int, NUM_EVENTS> fds;
+        for (size_t idx = 0; idx < NUM_EVENTS; idx++) fds[idx] = open(static_cast<Event>(idx), thread_id);
+        threads_.push_back(fds);
+    }
+#endif
+
+    bool anyAvailable() const {
+        for (size_t idx = 0; idx < NUM_EVENTS; idx++) if (availableOnAll(idx)) return true;
+        return false;
+    }
+
+    // Running totals of every counted thread since its counters were opened
+    Sample read() const {
+        Sample sample;
+#ifdef __linux__
+        for (size_t idx = 0; idx < NUM_EVENTS; idx++){
+            if (!availableOnAll(idx)) continue;
+            sample.available[idx] = true;
+            for (const auto& fds : threads_){
+                // Value, time enabled and time running, per PERF_FORMAT_TOTAL_TIME_*
+                uint64_t data[3]{};
+                if (::read(fds[idx], data, sizeof(data)) != sizeof(data)){
+                    sample.available[idx] = false;
+                    break;
+                }
+                sample.values[idx] += data[2] == 0 ? 0.0 : static_cast<double>(data[0]) * data[1] / data[2];
+            }
+        }
+#endif
+        return sample;
+    }
+
+private:
+    bool availableOnAll(size_t idx) const {
+        if (threads_.empty()) return false;
+        for (const auto& fds : threads_) if (fds[idx] < 0) return false;
+        return true;
+    }
+
+#ifdef __linux__
+    static int open(Event event, pid_t thread_id){
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        switch (event){
+            case CYCLES       : attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+            case INSTRUCTIONS : attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+            case LLC_MISSES   : attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+            case BRANCH_MISSES: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+            case L1D_MISSES   :
+                attr.type   = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            default: return -1;
+        }
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.inherit        = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, thread_id, -1, -1, 0));
+    }
+#endif
+
+    std::vector<std::array<int, NUM_EVENTS>> threads_;
+};
+
+} // namespace aoc::perf
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string_view>
+#include <source_location>
+
+#include "parse_cache.hpp"
+
+namespace aoc{
+
+// The two puzzle answers of a day. Days that only solve one part leave the other at zero
+struct Answer{
+    int64_t part1 = 0;
+    int64_t part2 = 0;
+
+    // Answers for independent pieces of an input add up part by part
+    Answer operator+(const Answer& other) const {
+        return Answer{.part1 = part1 + other.part1, .part2 = part2 + other.part2};
+    }
+};
+
+// Type erased parse and solve phases of a single day so they can be timed separately. Solving
+// never modifies the parsed data and days keep no global state, so a parsed input can be
+// solved repeatedly, and from several threads at once
+struct Solver{
+    int day;
+    std::filesystem::path input_file;
+    std::function<std::shared_ptr<const void>(std::string_view)> parse;
+    std::function<Answer(const void*)> solve;
+};
+
+// Wrap a day's parse and solve functions. The default input file is the
+// day_N_data.txt that sits next to the calling solver's source file
+template<typename Parsed>
+Solver makeSolver(int day, Parsed(*parse)(std::string_view), Answer(*solve)(const Parsed&),
+                  std::source_location location = std::source_location::current())
+{
+    return Solver{
+        .day        = day,
+        .input_file = std::filesystem::path(location.file_name()).replace_filename("day_" + std::to_string(day) + "_data.txt"),
+        .parse      = [parse](std::string_view input) -> std::shared_ptr<const void> {
+            return std::make_shared<Parsed>(parse(input));
+        },
+        .solve      = [solve](const void* parsed) -> Answer {
+            return solve(*static_cast<const Parsed*>(parsed));
+        }
+    };
+}
+
+// Same as above for a day that can store its parsed data in the binary parse cache
+template<typename Parsed>
+Solver makeSolver(int day, Parsed(*parse)(std::string_view), Answer(*solve)(const Parsed&), cache::CacheIO<Parsed> cache_io,
+                  std::source_location location = std::source_location::current())
+{
+    Solver solver = makeSolver(day, parse, solve, location);
+    solver.parse = [day, parse, cache_io](std::string_view input) -> std::shared_ptr<const void> {
+        return std::make_shared<Parsed>(cache::parseCached(day, input, parse, cache_io));
+    };
+    return solver;
+}
+
+// Every day linked into the solver library, in day order
+const std::vector<Solver>& allSolvers();
+
+} // namespace aoc
@@ -0,0 +1,192 @@
+#pragma once
+
+// Constant memory reader for inputs too big to load or map. Two large page aligned
+// buffers are filled with read() by a background thread, which reads the next block
+// while the caller works through the current one:
+//
+//     aoc::StreamReader reader("day_1_data.txt");
+//     for (std::string_view block; !(block = reader.next()).empty();) ...
+//
+// Every block ends on a line boundary. The unfinished line at the end of a read is
+// carried to the front of the other buffer, so no line is ever split between blocks.
+// A single line longer than a buffer is an error
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <system_error>
+#include <condition_variable>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "line_engine.hpp"
+
+namespace aoc{
+
+class StreamReader{
+public:
+    static constexpr size_t default_buffer_bytes = 8 * 1024 * 1024;
+    static constexpr size_t buffer_alignment = 4096;
+
+    // A file that can't be opened reads as empty, like loadInput and MappedInput
+    explicit StreamReader(const std::string& filename, size_t buffer_bytes = default_buffer_bytes) :
+        StreamReader(::open(filename.c_str(), O_RDONLY), buffer_bytes, true) {}
+
+    // Read from a descriptor that is already open, such as STDIN_FILENO. It is left open
+    explicit StreamReader(int fd, size_t buffer_bytes = default_buffer_bytes) :
+        StreamReader(fd, buffer_bytes, false) {}
+
+    ~StreamReader(){
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        changed_.notify_all();
+        if (reader_.joinable()) reader_.join();
+        if (owns_fd_ && fd_ >= 0) ::close(fd_);
+    }
+
+    StreamReader(const StreamReader&) = delete;
+    StreamReader& operator=(const StreamReader&) = delete;
+
+    bool isOpen() const {return fd_ >= 0;}
+
+    // Total size of the blocks handed out so far
+    size_t bytesRead() const {return bytes_read_;}
+
+    // The next block of whole lines, or an empty view once the input is used up. The
+    // previous block is handed back to the reader and must no longer be used
+    std::string_view next(){
+        std::unique_lock lock(mutex_);
+        if (holding_){
+            buffers_[current_].ready = false;
+            holding_ = false;
+            current_ ^= 1;
+            changed_.notify_all();
+        }
+        changed_.wait(lock, [this]{return buffers_[current_].ready || finished_ || error_;});
+        if (error_) std::rethrow_exception(error_);
+        if (!buffers_[current_].ready) return {};
+        holding_ = true;
+        bytes_read_ += buffers_[current_].lines_end;
+        return std::string_view(buffers_[current_].data.get(), buffers_[current_].lines_end);
+    }
+
+private:
+    struct FreeDeleter{
+        void operator()(char* ptr) const {std::free(ptr);}
+    };
+
+    struct Buffer{
+        std::unique_ptr<char[], FreeDeleter> data;
+        size_t lines_end = 0;  // Length of the whole lines at the front
+        size_t filled = 0;     // Bytes in the buffer, including the carried over partial line
+        bool ready = false;    // Filled and waiting for, or held by, the caller
+    };
+
+    StreamReader(int fd, size_t buffer_bytes, bool owns_fd) :
+        fd_(fd), owns_fd_(owns_fd),
+        buffer_bytes_((std::max(buffer_bytes, size_t{1}) + buffer_alignment - 1) / buffer_alignment * buffer_alignment)
+    {
+        if (fd_ < 0){
+            finished_ = true;
+            return;
+        }
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+        for (Buffer& buffer : buffers_){
+            buffer.data.reset(static_cast<char*>(std::aligned_alloc(buffer_alignment, buffer_bytes_)));
+            if (!buffer.data) throw std::bad_alloc();
+        }
+        reader_ = std::thread([this]{readLoop();});
+    }
+
+    void readLoop(){
+        try{
+            size_t carry_from = 0, carry_bytes = 0;
+            for (size_t slot = 0; ; slot ^= 1){
+                Buffer& buffer = buffers_[slot];
+                {
+                    std::unique_lock lock(mutex_);
+                    changed_.wait(lock, [&]{return !buffer.ready || stopping_;});
+                    if (stopping_) return;
+                }
+
+                // The carried tail lies past the other buffer's lines, which the caller never reads
+                std::memcpy(buffer.data.get(), buffers_[slot ^ 1].data.get() + carry_from, carry_bytes);
+                buffer.filled = carry_bytes;
+                const bool at_end = fill(buffer);
+
+                const std::string_view text(buffer.data.get(), buffer.filled);
+                const size_t last_newline = text.rfind('\n');
+                if (at_end) buffer.lines_end = buffer.filled;
+                else if (last_newline == std::string_view::npos) throw std::runtime_error("aoc::StreamReader: line longer than the buffer");
+                else buffer.lines_end = last_newline + 1;
+                carry_from  = buffer.lines_end;
+                carry_bytes = buffer.filled - buffer.lines_end;
+
+                std::lock_guard lock(mutex_);
+                buffer.ready = buffer.lines_end != 0;
+                finished_ = at_end;
+                changed_.notify_all();
+                if (at_end) return;
+            }
+        }catch (...){
+            std::lock_guard lock(mutex_);
+            error_ = std::current_exception();
+            changed_.notify_all();
+        }
+    }
+
+    // Read until the buffer is full or the input ends, returning whether it ended
+    bool fill(Buffer& buffer){
+        while (buffer.filled < buffer_bytes_){
+            const ssize_t count = ::read(fd_, buffer.data.get() + buffer.filled, buffer_bytes_ - buffer.filled);
+            if (count < 0 && errno == EINTR) continue;
+            if (count < 0) throw std::system_error(errno, std::generic_category(), "aoc::StreamReader: read failed");
+            if (count == 0) return true;
+            buffer.filled += count;
+        }
+        return false;
+    }
+
+    int fd_;
+    bool owns_fd_;
+    size_t buffer_bytes_;
+    Buffer buffers_[2];
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    size_t current_ = 0;
+    size_t bytes_read_ = 0;
+    bool holding_   = false;
+    bool finished_  = false;
+    bool stopping_  = false;
+    std::exception_ptr error_;
+    std::thread reader_;
+};
+
+// LineEngine::mapReduce over a whole stream, one block at a time. Block results are
+// folded together in input order with the same reduce
+template<typename Map, typename Reduce>
+auto mapReduceStream(StreamReader& reader, Map&& map_line, Reduce&& reduce, const LineEngine& engine = LineEngine{}){
+    using Result = std::decay_t<std::invoke_result_t<Map&, std::string_view>>;
+    Result total{};
+    for (std::string_view block; !(block = reader.next()).empty();){
+        total = std::invoke(reduce, std::move(total), engine.mapReduce(block, map_line, reduce));
+    }
+    return total;
+}
+
+} // namespace aoc
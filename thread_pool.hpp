@@ -0,0 +1,123 @@
+#pragma once
+
+#include <latch>
+#include <mutex>
+#include <memory>
+#include <deque>
+#include <future>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+namespace aoc{
+
+// Fixed set of worker threads pulling tasks off a shared FIFO queue. Workers are
+// joined when the pool is destroyed, after the tasks already queued have run
+class ThreadPool{
+public:
+    explicit ThreadPool(size_t num_threads = defaultThreadCount()){
+        workers_.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; i++){
+            workers_.emplace_back([this]{workerLoop();});
+        }
+    }
+
+    ~ThreadPool(){
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const {return workers_.size();}
+
+    // Queue task to run on a worker, the future holds its result or exception
+    template<typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        using Result = std::invoke_result_t<std::decay_t<F>&>;
+        std::packaged_task<Result()> packaged(std::forward<F>(task));
+        std::future<Result> result = packaged.get_future();
+        post(std::move(packaged));
+        return result;
+    }
+
+    // Queue task without a way to wait on it. It must not throw
+    void post(std::move_only_function<void()> task){
+        {
+            std::lock_guard lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        wake_.notify_one();
+    }
+
+    // Run task once on every worker and wait for all of them, e.g. to set up per thread
+    // state. Each worker is held until all have started, so none can take two. It must not
+    // throw, and must not be called from one of this pool's own workers
+    template<typename F>
+    void runOnEachWorker(F&& task){
+        // A worker can still be inside count_down when the wait returns, so the latches
+        // are kept alive by the workers too
+        struct Rendezvous{
+            explicit Rendezvous(std::ptrdiff_t count) : started(count), finished(count) {}
+            std::latch started;
+            std::latch finished;
+        };
+        const std::ptrdiff_t count = workers_.size();
+        auto rendezvous = std::make_shared<Rendezvous>(count);
+        for (std::ptrdiff_t i = 0; i < count; i++){
+            post([rendezvous, &task]{
+                task();
+                rendezvous->started.arrive_and_wait();
+                rendezvous->finished.count_down();
+            });
+        }
+        rendezvous->finished.wait();
+    }
+
+    // Pool shared by the whole process, sized by AOC_THREADS or else the core count
+    static ThreadPool& shared(){
+        static ThreadPool pool;
+        return pool;
+    }
+
+    static size_t defaultThreadCount(){
+        if (const char* env = std::getenv("AOC_THREADS")){
+            const long requested = std::strtol(env, nullptr, 10);
+            if (requested > 0) return static_cast<size_t>(requested);
+        }
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+private:
+    void workerLoop(){
+        for (;;){
+            std::move_only_function<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [this]{return stopping_ || !tasks_.empty();});
+                if (tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::move_only_function<void()>> tasks_;
+    bool stopping_ = false;
+    // Declared last so the threads are joined before the queue they use is destroyed
+    std::vector<std::jthread> workers_;
+};
+
+} // namespace aoc
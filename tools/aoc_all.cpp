@@ -0,0 +1,146 @@
+#include <array>
+#include <print>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ranges>
+#include <optional>
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <string_view>
+
+#include "load_input.hpp"
+#include "solver.hpp"
+#include "thread_pool.hpp"
+#include "cli_args.hpp"
+
+namespace ranges = std::ranges;
+
+using Clock = std::chrono::steady_clock;
+
+// Days that take the longest, queued ahead of the rest so the cheap days fill in around them
+static constexpr std::array expensive_days{5, 12, 16, 17, 20};
+
+struct Options{
+    std::vector<int> days;
+    std::filesystem::path data_dir;
+    std::optional<std::filesystem::path> parse_cache;
+};
+
+struct DayResult{
+    int day = 0;
+    aoc::Answer answer;
+    double parse_ms = 0;
+    double solve_ms = 0;
+    std::string error;
+};
+
+static void printUsage(){
+    std::println(stderr, "Usage: aoc_all [--days 1,5,9-20] [--data-dir DIR] [--parse-cache DIR]");
+    std::println(stderr, "  --days         Days to run, as a comma separated list of days or ranges (default all)");
+    std::println(stderr, "  --data-dir     Directory holding day_N_data.txt (default next to each solver's source)");
+    std::println(stderr, "  --parse-cache  Directory for binary parse caches, overriding AOC_PARSE_CACHE (\"\" turns it off)");
+}
+
+static std::optional<Options> parseArgs(int argc, char** argv){
+    Options options;
+    for (int idx = 1; idx < argc; idx++){
+        std::string_view arg(argv[idx]);
+        const bool has_value = idx + 1 < argc;
+        if (arg == "--days" && has_value){
+            if (!aoc::parseDays(argv[++idx], options.days)) return {};
+        }else if (arg == "--data-dir" && has_value){
+            options.data_dir = argv[++idx];
+        }else if (arg == "--parse-cache" && has_value){
+            options.parse_cache = argv[++idx];
+        }else{
+            return {};
+        }
+    }
+    return options;
+}
+
+static double elapsedMillis(Clock::time_point start, Clock::time_point stop){
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+static DayResult runDay(const aoc::Solver& solver, const std::filesystem::path& input_file){
+    DayResult result{.day = solver.day};
+    MappedInput input = mapInput(input_file.string());
+    if (input.empty()){
+        result.error = "could not read " + input_file.string();
+        return result;
+    }
+
+    const auto parse_start = Clock::now();
+    std::shared_ptr<const void> parsed = solver.parse(input);
+    const auto solve_start = Clock::now();
+    result.answer = solver.solve(parsed.get());
+    const auto solve_stop = Clock::now();
+
+    result.parse_ms = elapsedMillis(parse_start, solve_start);
+    result.solve_ms = elapsedMillis(solve_start, solve_stop);
+    return result;
+}
+
+int main(int argc, char** argv){
+    std::optional<Options> options = parseArgs(argc, argv);
+    if (!options){
+        printUsage();
+        return 1;
+    }
+    if (std::optional<int> day = aoc::unknownDay(options->days, aoc::allSolvers(), &aoc::Solver::day)){
+        std::println(stderr, "There is no solver for day {}", *day);
+        return 1;
+    }
+    if (options->parse_cache) aoc::cache::setDirectory(*options->parse_cache);
+
+    std::vector<const aoc::Solver*> selected;
+    for (const aoc::Solver& solver : aoc::allSolvers()){
+        if (options->days.empty() || ranges::contains(options->days, solver.day)) selected.push_back(&solver);
+    }
+    ranges::stable_partition(selected, [](const aoc::Solver* solver){return ranges::contains(expensive_days, solver->day);});
+
+    // Days run as tasks on the same pool their line engines use, so nested work shares the
+    // cores. A day waiting on its own chunks works through them itself, so it never deadlocks
+    aoc::ThreadPool& pool = aoc::ThreadPool::shared();
+
+    const auto start = Clock::now();
+    std::vector<std::future<DayResult>> pending;
+    for (const aoc::Solver* solver : selected){
+        const std::filesystem::path input_file = options->data_dir.empty() ?
+            solver->input_file :
+            options->data_dir / solver->input_file.filename();
+        pending.push_back(pool.submit([solver, input_file]{return runDay(*solver, input_file);}));
+    }
+
+    std::vector<DayResult> results;
+    for (auto [solver, future] : std::views::zip(selected, pending)){
+        try{
+            results.push_back(future.get());
+        }catch (const std::exception& e){
+            results.push_back(DayResult{.day = solver->day, .error = e.what()});
+        }
+    }
+    const auto stop = Clock::now();
+
+    ranges::sort(results, {}, &DayResult::day);
+    std::println("{:>4} {:>12} {:>12} {:>12}   {}", "day", "parse (ms)", "solve (ms)", "total (ms)", "answer");
+    double serial_ms = 0;
+    int failures = 0;
+    for (const DayResult& result : results){
+        if (!result.error.empty()){
+            std::println("{:>4} {:>12} {:>12} {:>12}   {}", result.day, "-", "-", "-", result.error);
+            failures++;
+            continue;
+        }
+        const double total_ms = result.parse_ms + result.solve_ms;
+        serial_ms += total_ms;
+        std::println("{:>4} {:>12.2f} {:>12.2f} {:>12.2f}   {} / {}", result.day, result.parse_ms, result.solve_ms, total_ms, result.answer.part1, result.answer.part2);
+    }
+    std::println("Wall clock {:.2f} ms on {} threads, {:.2f} ms of solver time", elapsedMillis(start, stop), pool.size(), serial_ms);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,267 @@
+#include <print>
+#include <mutex>
+#include <chrono>
+#include <format>
+#include <string>
+#include <vector>
+#include <ranges>
+#include <optional>
+#include <algorithm>
+#include <string_view>
+
+#include "load_input.hpp"
+#include "solver.hpp"
+#include "instrument.hpp"
+#include "memory_profile.hpp"
+#include "perf_counters.hpp"
+#include "thread_pool.hpp"
+#include "bench_stats.hpp"
+#include "bench_baseline.hpp"
+#include "cli_args.hpp"
+
+namespace views  = std::views;
+namespace ranges = std::ranges;
+
+using Clock = std::chrono::steady_clock;
+
+struct Options{
+    std::vector<int> days;
+    int warmup = 1;
+    int reps   = 10;
+    std::filesystem::path data_dir;
+    std::optional<std::filesystem::path> parse_cache;
+    std::filesystem::path save_baseline;
+    std::filesystem::path compare_baseline;
+    double threshold = 5.0;
+    double alpha     = 0.05;
+    bool perf        = false;
+};
+
+// Hardware counter totals of one phase over every timed run
+struct PerfRow{
+    int day;
+    std::string_view phase;
+    aoc::perf::Sample sample;
+};
+
+static void printUsage(){
+    std::println(stderr, "Usage: aoc_bench [--days 1,5,9-20] [--warmup N] [--reps N] [--data-dir DIR] [--parse-cache DIR]");
+    std::println(stderr, "                 [--save-baseline FILE] [--compare FILE] [--threshold PCT] [--alpha P] [--perf]");
+    std::println(stderr, "  --days           Days to run, as a comma separated list of days or ranges (default all)");
+    std::println(stderr, "  --warmup         Untimed runs before measuring (default 1)");
+    std::println(stderr, "  --reps           Timed runs per day (default 10)");
+    std::println(stderr, "  --data-dir       Directory holding day_N_data.txt (default next to each solver's source)");
+    std::println(stderr, "  --parse-cache    Directory for binary parse caches, overriding AOC_PARSE_CACHE (\"\" turns it off)");
+    std::println(stderr, "  --save-baseline  Write the medians and variances of this run to FILE");
+    std::println(stderr, "  --compare        Compare this run against a saved baseline, exiting with 2 on a regression");
+    std::println(stderr, "  --threshold      Slowdown of the median in percent that counts as a regression (default 5)");
+    std::println(stderr, "  --alpha          Significance level of the Welch's t-test on the means (default 0.05)");
+    std::println(stderr, "  --perf           Report hardware counters per phase (cycles, IPC, cache and branch misses)");
+}
+
+static std::optional<Options> parseArgs(int argc, char** argv){
+    Options options;
+    for (int idx = 1; idx < argc; idx++){
+        std::string_view arg(argv[idx]);
+        const bool has_value = idx + 1 < argc;
+        if (arg == "--days" && has_value){
+            if (!aoc::parseDays(argv[++idx], options.days)) return {};
+        }else if (arg == "--warmup" && has_value){
+            if (!aoc::parseInt(argv[++idx], options.warmup) || options.warmup < 0) return {};
+        }else if (arg == "--reps" && has_value){
+            if (!aoc::parseInt(argv[++idx], options.reps) || options.reps < 1) return {};
+        }else if (arg == "--data-dir" && has_value){
+            options.data_dir = argv[++idx];
+        }else if (arg == "--parse-cache" && has_value){
+            options.parse_cache = argv[++idx];
+        }else if (arg == "--save-baseline" && has_value){
+            options.save_baseline = argv[++idx];
+        }else if (arg == "--compare" && has_value){
+            options.compare_baseline = argv[++idx];
+        }else if (arg == "--threshold" && has_value){
+            if (!aoc::parseFloat(argv[++idx], options.threshold) || options.threshold < 0) return {};
+        }else if (arg == "--perf"){
+            options.perf = true;
+        }else if (arg == "--alpha" && has_value){
+            if (!aoc::parseFloat(argv[++idx], options.alpha) || options.alpha <= 0 || options.alpha >= 1) return {};
+        }else{
+            return {};
+        }
+    }
+    return options;
+}
+
+static std::filesystem::path inputFile(const aoc::Solver& solver, const Options& options){
+    return options.data_dir.empty() ? solver.input_file : options.data_dir / solver.input_file.filename();
+}
+
+static double mebibytes(double bytes){
+    return bytes / (1024.0 * 1024.0);
+}
+
+// One extra run with the parse and solve phases measured separately
+static void reportMemory(const aoc::Solver& solver, std::string_view input){
+    std::shared_ptr<const void> parsed;
+    const aoc::memory::PhaseUsage parse_usage = aoc::memory::measure([&]{parsed = solver.parse(input);});
+    const aoc::memory::PhaseUsage solve_usage = aoc::memory::measure([&]{solver.solve(parsed.get());});
+    for (auto [phase, usage] : {std::pair{"parse", parse_usage}, std::pair{"solve", solve_usage}}){
+        std::println("{:>4} {:>6} {:>16} {:>16.2f} {:>16.2f} {:>16.2f}", solver.day, phase, usage.allocations,
+            mebibytes(usage.allocated_bytes), mebibytes(usage.peak_heap_bytes), mebibytes(usage.peak_rss_bytes));
+    }
+}
+
+// Print every phase next to its baseline and return whether any of them regressed
+static bool compareToBaseline(const std::vector<aoc::BaselineEntry>& baseline, const std::vector<aoc::BaselineEntry>& results, const Options& options){
+    std::println("\n{:>4} {:>6} {:>14} {:>14} {:>9} {:>9}   {}", "day", "phase", "base (us)", "median (us)", "change", "p-value", "verdict");
+    bool regressed = false;
+    for (const aoc::BaselineEntry& result : results){
+        const aoc::BaselineEntry* before = aoc::findBaseline(baseline, result.day, result.phase);
+        if (!before){
+            std::println("{:>4} {:>6} {:>14} {:>14.1f} {:>9} {:>9}   {}", result.day, result.phase, "-", result.stats.median, "-", "-", "new");
+            continue;
+        }
+        const double change = before->stats.median > 0 ? (result.stats.median / before->stats.median - 1.0) * 100.0 : 0.0;
+        const double p_value = aoc::welchSlowerPValue(before->stats, result.stats);
+        const bool slower = aoc::isRegression(before->stats, result.stats, options.threshold / 100.0, options.alpha);
+        const bool faster = aoc::isRegression(result.stats, before->stats, options.threshold / 100.0, options.alpha);
+        regressed |= slower;
+        std::println("{:>4} {:>6} {:>14.1f} {:>14.1f} {:>+8.1f}% {:>9.4f}   {}", result.day, result.phase, before->stats.median, result.stats.median,
+            change, p_value, slower ? "REGRESSION" : faster ? "faster" : "ok");
+    }
+    return regressed;
+}
+
+static void printPerf(const std::vector<PerfRow>& rows, int reps){
+    std::println("\n{:>4} {:>6} {:>16} {:>16} {:>6} {:>14} {:>14} {:>14}", "day", "phase", "cycles", "instructions", "IPC", "L1D misses", "LLC misses", "branch misses");
+    auto count = [reps](const aoc::perf::Sample& sample, aoc::perf::Event event){
+        return sample.has(event) ? std::format("{:.0f}", sample[event] / reps) : std::string("-");
+    };
+    for (const PerfRow& row : rows){
+        const std::string ipc = row.sample.ipc() > 0 ? std::format("{:.2f}", row.sample.ipc()) : std::string("-");
+        std::println("{:>4} {:>6} {:>16} {:>16} {:>6} {:>14} {:>14} {:>14}", row.day, row.phase,
+            count(row.sample, aoc::perf::CYCLES), count(row.sample, aoc::perf::INSTRUCTIONS), ipc,
+            count(row.sample, aoc::perf::L1D_MISSES), count(row.sample, aoc::perf::LLC_MISSES), count(row.sample, aoc::perf::BRANCH_MISSES));
+    }
+}
+
+// Counts the pool's workers by id. They must already exist when the main thread's counters
+// are opened, or they would inherit those counters and be counted twice
+static void addPoolWorkers(aoc::perf::Counters& counters, aoc::ThreadPool& pool){
+#ifdef __linux__
+    std::mutex mutex;
+    std::vector<pid_t> thread_ids;
+    pool.runOnEachWorker([&]{
+        std::lock_guard lock(mutex);
+        thread_ids.push_back(aoc::perf::currentThreadId());
+    });
+    for (pid_t thread_id : thread_ids) counters.addThread(thread_id);
+#endif
+}
+
+static double elapsedMicros(Clock::time_point start, Clock::time_point stop){
+    return std::chrono::duration<double, std::micro>(stop - start).count();
+}
+
+int main(int argc, char** argv){
+    std::optional<Options> options = parseArgs(argc, argv);
+    if (!options){
+        printUsage();
+        return 1;
+    }
+    if (std::optional<int> day = aoc::unknownDay(options->days, aoc::allSolvers(), &aoc::Solver::day)){
+        std::println(stderr, "There is no solver for day {}", *day);
+        return 1;
+    }
+    if (options->parse_cache) aoc::cache::setDirectory(*options->parse_cache);
+
+    std::optional<std::vector<aoc::BaselineEntry>> baseline;
+    if (!options->compare_baseline.empty()){
+        baseline = aoc::loadBaseline(options->compare_baseline);
+        if (!baseline){
+            std::println(stderr, "Could not read baseline {}", options->compare_baseline.string());
+            return 1;
+        }
+    }
+
+    std::optional<aoc::perf::Counters> counters;
+    std::vector<PerfRow> perf_rows;
+    if (options->perf){
+        // The shared pool starts its workers on first use, so start it before any counter is open
+        aoc::ThreadPool& pool = aoc::ThreadPool::shared();
+        counters.emplace();
+        addPoolWorkers(*counters, pool);
+        if (!counters->anyAvailable()) std::println(stderr, "Hardware counters are unavailable here (check /proc/sys/kernel/perf_event_paranoid)");
+    }
+
+    std::vector<aoc::BaselineEntry> results;
+    std::println("{:>4} {:>6} {:>14} {:>14} {:>14}   {}", "day", "phase", "min (us)", "median (us)", "p99 (us)", "answer");
+    for (const aoc::Solver& solver : aoc::allSolvers()){
+        if (!options->days.empty() && !ranges::contains(options->days, solver.day)) continue;
+
+        const std::filesystem::path input_file = inputFile(solver, *options);
+        MappedInput input = mapInput(input_file.string());
+        if (input.empty()){
+            std::println(stderr, "Skipping day {}, could not read {}", solver.day, input_file.string());
+            continue;
+        }
+
+        // Every run parses from scratch so both phases are timed. With a parse cache the warmup
+        // runs also write it, so the timed runs measure loading it back
+        for (int _ : views::iota(0, options->warmup)){
+            std::shared_ptr<const void> parsed = solver.parse(input);
+            solver.solve(parsed.get());
+        }
+
+        std::vector<double> parse_times;
+        std::vector<double> solve_times;
+        aoc::perf::Sample parse_perf, solve_perf;
+        aoc::Answer answer;
+        for (int _ : views::iota(0, options->reps)){
+            AOC_INSTRUMENT_RESET();
+            const aoc::perf::Sample perf_start = counters ? counters->read() : aoc::perf::Sample{};
+            const auto parse_start = Clock::now();
+            std::shared_ptr<const void> parsed = solver.parse(input);
+            const auto parse_stop = Clock::now();
+            const aoc::perf::Sample perf_parsed = counters ? counters->read() : aoc::perf::Sample{};
+            const auto solve_start = Clock::now();
+            answer = solver.solve(parsed.get());
+            const auto solve_stop = Clock::now();
+            if (counters){
+                const aoc::perf::Sample perf_solved = counters->read();
+                parse_perf += perf_parsed - perf_start;
+                solve_perf += perf_solved - perf_parsed;
+                parse_perf.available = solve_perf.available = perf_solved.available;
+            }
+
+            parse_times.push_back(elapsedMicros(parse_start, parse_stop));
+            solve_times.push_back(elapsedMicros(solve_start, solve_stop));
+            AOC_INSTRUMENT_REPORT(solver.day, input.size());
+        }
+
+        const aoc::PhaseStats parse_stats = aoc::summarize(std::move(parse_times));
+        const aoc::PhaseStats solve_stats = aoc::summarize(std::move(solve_times));
+        std::println("{:>4} {:>6} {:>14.1f} {:>14.1f} {:>14.1f}", solver.day, "parse", parse_stats.min, parse_stats.median, parse_stats.p99);
+        std::println("{:>4} {:>6} {:>14.1f} {:>14.1f} {:>14.1f}   {} / {}", solver.day, "solve", solve_stats.min, solve_stats.median, solve_stats.p99, answer.part1, answer.part2);
+        results.push_back({.day = solver.day, .phase = "parse", .stats = parse_stats});
+        results.push_back({.day = solver.day, .phase = "solve", .stats = solve_stats});
+        if (counters){
+            perf_rows.push_back({.day = solver.day, .phase = "parse", .sample = parse_perf});
+            perf_rows.push_back({.day = solver.day, .phase = "solve", .sample = solve_perf});
+        }
+    }
+    if (counters && counters->anyAvailable()) printPerf(perf_rows, options->reps);
+    if (!options->save_baseline.empty() && !aoc::saveBaseline(options->save_baseline, results)){
+        std::println(stderr, "Could not write baseline {}", options->save_baseline.string());
+    }
+    const bool regressed = baseline && compareToBaseline(*baseline, results, *options);
+
+    if constexpr (aoc::memory::enabled){
+        std::println("\n{:>4} {:>6} {:>16} {:>16} {:>16} {:>16}", "day", "phase", "allocations", "alloc (MiB)", "peak heap (MiB)", "peak RSS (MiB)");
+        for (const aoc::Solver& solver : aoc::allSolvers()){
+            if (!options->days.empty() && !ranges::contains(options->days, solver.day)) continue;
+            MappedInput input = mapInput(inputFile(solver, *options).string());
+            if (!input.empty()) reportMemory(solver, input);
+        }
+    }
+    return regressed ? 2 : 0;
+}
@@ -0,0 +1,754 @@
+#include <array>
+#include <cmath>
+#include <deque>
+#include <print>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+#include <ranges>
+#include <numeric>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+
+#include "cli_args.hpp"
+
+namespace views  = std::views;
+namespace ranges = std::ranges;
+
+using Rng   = std::mt19937_64;
+using Clock = std::chrono::steady_clock;
+
+// Buffered output file, flushed in large blocks so multi-GB inputs never sit in memory
+class Writer{
+public:
+    explicit Writer(const std::filesystem::path& path) : file_(std::fopen(path.c_str(), "wb")) {}
+    ~Writer(){close();}
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    size_t bytesWritten() const {return bytes_written_ + buffer_.size();}
+
+    void put(char c){
+        buffer_.push_back(c);
+        flushIfFull();
+    }
+
+    void write(std::string_view str){
+        buffer_.append(str);
+        flushIfFull();
+    }
+
+    template<typename... Args>
+    void print(std::format_string<Args...> fmt, Args&&... args){
+        std::format_to(std::back_inserter(buffer_), fmt, std::forward<Args>(args)...);
+        flushIfFull();
+    }
+
+    // Returns false if anything failed to write
+    bool close(){
+        if (!file_) return false;
+        flush();
+        failed_ = std::fclose(file_) != 0 || failed_;
+        file_ = nullptr;
+        return !failed_;
+    }
+
+private:
+    static constexpr size_t flush_threshold = 1 << 20;
+
+    void flushIfFull(){
+        if (buffer_.size() >= flush_threshold) flush();
+    }
+
+    void flush(){
+        if (file_ && std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) failed_ = true;
+        bytes_written_ += buffer_.size();
+        buffer_.clear();
+    }
+
+    std::FILE* file_;
+    std::string buffer_;
+    size_t bytes_written_ = 0;
+    bool failed_ = false;
+};
+
+// The standard distributions and std::shuffle may differ between standard libraries, so
+// the draws are written out here to keep a seed's files the same everywhere. The engine and
+// std::seed_seq are fully specified already
+
+// Uniform in [lo, hi] by Lemire's multiply-shift, rejecting the few low products that would
+// bias it
+static int64_t uniform(Rng& rng, int64_t lo, int64_t hi){
+    const uint64_t range = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo) + 1;
+    if (range == 0) return static_cast<int64_t>(rng());
+    unsigned __int128 product = static_cast<unsigned __int128>(rng()) * range;
+    if (static_cast<uint64_t>(product) < range){
+        const uint64_t threshold = -range % range;
+        while (static_cast<uint64_t>(product) < threshold) product = static_cast<unsigned __int128>(rng()) * range;
+    }
+    return static_cast<int64_t>(static_cast<uint64_t>(lo) + static_cast<uint64_t>(product >> 64));
+}
+
+// True with the given probability, from the top 53 bits of a draw
+static bool chance(Rng& rng, double probability){
+    return static_cast<double>(rng() >> 11) * 0x1p-53 < probability;
+}
+
+// Fisher-Yates, drawing each swap with uniform
+template<ranges::random_access_range Range>
+static void shuffle(Range&& range, Rng& rng){
+    const auto first = ranges::begin(range);
+    for (int64_t idx = ranges::ssize(range) - 1; idx > 0; idx--) ranges::iter_swap(first + idx, first + uniform(rng, 0, idx));
+}
+
+// Grids grow in area with the scale, so each side grows with its square root
+static int gridSide(int base, int64_t scale){
+    return std::max(5, static_cast<int>(std::lround(base * std::sqrt(static_cast<double>(scale)))));
+}
+
+// Distinct lowercase labels of at least two characters ("ba", "bb", ...)
+static std::string lowercaseLabel(int64_t id){
+    std::string label;
+    for (id += 26; id > 0; id /= 26){
+        label.push_back(static_cast<char>('a' + id % 26));
+    }
+    ranges::reverse(label);
+    return label;
+}
+
+// Ordered so that the value is the direction digit of a day 18 hex code
+enum Dir{
+    EAST,
+    SOUTH,
+    WEST,
+    NORTH
+};
+
+struct Edge{
+    Dir dir;
+    int64_t length;
+};
+
+// Closed rectilinear loop shaped like a thick staircase running down and to the right:
+// R a0, D b0, ..., R a(k-1), D t, L a(k-1), U b(k-2), ..., L a0, U t. The two sides
+// never touch as long as the thickness t is greater than every step down b
+static std::vector<Edge> bandOutline(Rng& rng, int64_t steps, int64_t max_step, int64_t thickness){
+    std::vector<int64_t> across(steps);
+    std::vector<int64_t> down(steps - 1);
+    for (int64_t& a : across) a = uniform(rng, 1, max_step);
+    for (int64_t& b : down)   b = uniform(rng, 1, max_step);
+
+    std::vector<Edge> edges;
+    edges.reserve(4*steps);
+    for (int64_t idx = 0; idx < steps; idx++){
+        edges.push_back({EAST, across[idx]});
+        if (idx + 1 < steps) edges.push_back({SOUTH, down[idx]});
+    }
+    edges.push_back({SOUTH, thickness});
+    for (int64_t idx = steps - 1; idx >= 0; idx--){
+        edges.push_back({WEST, across[idx]});
+        if (idx > 0) edges.push_back({NORTH, down[idx-1]});
+    }
+    edges.push_back({NORTH, thickness});
+    return edges;
+}
+
+// Random grid written a row at a time, with each cell chosen by cell(rng)
+template<typename F>
+static void writeGrid(Writer& out, Rng& rng, int side, F&& cell){
+    std::string row(side, '.');
+    for (int _ : views::iota(0, side)){
+        ranges::generate(row, [&]{return cell(rng);});
+        out.write(row);
+        out.put('\n');
+    }
+}
+
+static void generateDay1(Writer& out, Rng& rng, int64_t scale){
+    static constexpr std::array<std::string_view, 9> digit_names{
+        "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"
+    };
+    for (int64_t _ = 0; _ < 1000*scale; _++){
+        // Every line gets at least one real digit so part 1 always has an answer
+        const int64_t pieces = uniform(rng, 2, 8);
+        const int64_t digit_piece = uniform(rng, 0, pieces - 1);
+        for (int64_t piece = 0; piece < pieces; piece++){
+            const int64_t kind = piece == digit_piece ? 0 : uniform(rng, 0, 3);
+            if (kind == 0){
+                out.put(static_cast<char>('1' + uniform(rng, 0, 8)));
+            }else if (kind == 1){
+                out.write(digit_names[uniform(rng, 0, 8)]);
+            }else{
+                for (int64_t letters = uniform(rng, 1, 5); letters > 0; letters--){
+                    out.put(static_cast<char>('a' + uniform(rng, 0, 25)));
+                }
+            }
+        }
+        out.put('\n');
+    }
+}
+
+static void generateDay2(Writer& out, Rng& rng, int64_t scale){
+    static constexpr std::array<std::string_view, 3> colours{"red", "green", "blue"};
+    std::array<int, 3> order{0, 1, 2};
+    for (int64_t game = 1; game <= 100*scale; game++){
+        out.print("Game {}: ", game);
+        for (int64_t round = 0, rounds = uniform(rng, 3, 6); round < rounds; round++){
+            if (round > 0) out.write("; ");
+            shuffle(order, rng);
+            for (int64_t idx = 0, shown = uniform(rng, 1, 3); idx < shown; idx++){
+                if (idx > 0) out.write(", ");
+                out.print("{} {}", uniform(rng, 1, 20), colours[order[idx]]);
+            }
+        }
+        out.put('\n');
+    }
+}
+
+static void generateDay3(Writer& out, Rng& rng, int64_t scale){
+    static constexpr std::string_view symbols = "*#+$/@=%&-";
+    const int side = gridSide(140, scale);
+    std::string row(side, '.');
+    for (int _ : views::iota(0, side)){
+        ranges::fill(row, '.');
+        for (int x = 0; x < side;){
+            if (chance(rng, 0.12)){
+                // Part numbers are one to three digits with at least one '.' after them
+                const int len = std::min<int>(uniform(rng, 1, 3), side - x);
+                row[x] = static_cast<char>('1' + uniform(rng, 0, 8));
+                for (int idx = 1; idx < len; idx++) row[x+idx] = static_cast<char>('0' + uniform(rng, 0, 9));
+                x += len + 1;
+            }else{
+                if (chance(rng, 0.06)) row[x] = symbols[uniform(rng, 0, symbols.size() - 1)];
+                x++;
+            }
+        }
+        out.write(row);
+        out.put('\n');
+    }
+}
+
+static void generateDay4(Writer& out, Rng& rng, int64_t scale){
+    // Cards only win copies of cards within the same block of ten, which keeps the
+    // number of copies (and the solver's recursion depth) bounded at any scale
+    static constexpr int64_t block = 10;
+    static constexpr int64_t winning_count = 10;
+    static constexpr int64_t our_count     = 25;
+
+    std::array<int, 99> pool;
+    std::iota(pool.begin(), pool.end(), 1);
+    std::array<int, our_count> ours;
+
+    const int64_t cards = 200*scale;
+    for (int64_t card = 1; card <= cards; card++){
+        const int64_t max_matches = std::min({winning_count, block - 1 - (card - 1) % block, cards - card});
+        const int64_t matches = std::min(uniform(rng, 0, max_matches), uniform(rng, 0, max_matches));
+
+        // The first ten of the shuffled pool win, and ours takes exactly the matching count of them
+        shuffle(pool, rng);
+        ranges::copy(pool | views::take(matches), ours.begin());
+        ranges::copy(pool | views::drop(winning_count) | views::take(our_count - matches), ours.begin() + matches);
+        shuffle(ours, rng);
+
+        out.print("Card {:>3}:", card);
+        for (int num : pool | views::take(winning_count)) out.print(" {:>2}", num);
+        out.write(" |");
+        for (int num : ours) out.print(" {:>2}", num);
+        out.put('\n');
+    }
+}
+
+static void generateDay5(Writer& out, Rng& rng, int64_t scale){
+    static constexpr std::array<std::string_view, 7> map_names{
+        "seed-to-soil", "soil-to-fertilizer", "fertilizer-to-water", "water-to-light",
+        "light-to-temperature", "temperature-to-humidity", "humidity-to-location"
+    };
+    static constexpr int64_t space = int64_t{1} << 32;
+
+    out.write("seeds:");
+    for (int64_t _ = 0; _ < 10*scale; _++){
+        const int64_t len = uniform(rng, 1, 200'000);
+        out.print(" {} {}", uniform(rng, 0, space - len), len);
+    }
+    out.put('\n');
+
+    // Each map cuts the space into ranges and lays them back out in a shuffled order,
+    // so like the puzzle input every map is a bijection with no overlapping sources
+    std::vector<int64_t> cuts;
+    std::vector<int64_t> dest;
+    std::vector<size_t> order;
+    for (std::string_view name : map_names){
+        out.print("\n{} map:\n", name);
+
+        cuts.assign({0, space});
+        for (int64_t _ = 1; _ < 30*scale; _++) cuts.push_back(uniform(rng, 1, space - 1));
+        ranges::sort(cuts);
+        cuts.erase(ranges::unique(cuts).begin(), cuts.end());
+
+        const size_t ranges_count = cuts.size() - 1;
+        order.resize(ranges_count);
+        std::iota(order.begin(), order.end(), 0);
+        shuffle(order, rng);
+        dest.resize(ranges_count);
+        int64_t next_dest = 0;
+        for (size_t idx : order){
+            dest[idx] = next_dest;
+            next_dest += cuts[idx+1] - cuts[idx];
+        }
+
+        shuffle(order, rng);
+        for (size_t idx : order){
+            out.print("{} {} {}\n", dest[idx], cuts[idx], cuts[idx+1] - cuts[idx]);
+        }
+    }
+}
+
+static void generateDay6(Writer& out, Rng& rng, int64_t /*scale*/){
+    // Part 2 joins every race into one 64 bit number, so this input can't grow with the scale.
+    // Retry until that joined race is still winnable
+    std::array<int64_t, 4> times;
+    std::array<int64_t, 4> dists;
+    for (;;){
+        for (auto [time, dist] : views::zip(times, dists)){
+            time = uniform(rng, 40, 99);
+            dist = uniform(rng, time*time/8, time*time/4 - 1);
+        }
+        auto join = [](const auto& vals){
+            std::string joined;
+            for (int64_t val : vals) joined += std::to_string(val);
+            return std::stoll(joined);
+        };
+        const int64_t big_time = join(times);
+        const int64_t big_dist = join(dists);
+        if (big_dist < big_time/2 * (big_time/2)) break;
+    }
+
+    out.write("Time:    ");
+    for (int64_t time : times) out.print(" {:>6}", time);
+    out.write("\nDistance:");
+    for (int64_t dist : dists) out.print(" {:>6}", dist);
+    out.put('\n');
+}
+
+static void generateDay7(Writer& out, Rng& rng, int64_t scale){
+    static constexpr std::string_view cards = "23456789TJQKA";
+    for (int64_t _ = 0; _ < 1000*scale; _++){
+        for (int _ : views::iota(0, 5)) out.put(cards[uniform(rng, 0, cards.size() - 1)]);
+        out.print(" {}\n", uniform(rng, 1, 1000));
+    }
+}
+
+static void generateDay8(Writer& out, Rng& rng, int64_t scale){
+    // Every ghost walks a single loop from its xxA start through xxZ and back round.
+    // Labels are three characters, so the loops can only grow until the 36*36*34
+    // inner labels run out; the instruction line carries the rest of the scale
+    static constexpr std::string_view label_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    static constexpr std::string_view inner_last  = "BCDEFGHIJKLMNOPQRSTUVWXY0123456789";
+    static constexpr std::array<int64_t, 6> cycle_primes{43, 47, 53, 59, 61, 67};
+    const int64_t cycle_scale = std::min<int64_t>(scale, 128);
+
+    auto innerLabel = [](int64_t id){
+        std::string label(3, ' ');
+        label[2] = inner_last[id % inner_last.size()];
+        id /= inner_last.size();
+        label[1] = label_chars[id % label_chars.size()];
+        label[0] = label_chars[id / label_chars.size()];
+        return label;
+    };
+
+    for (int64_t _ = 0; _ < 263*scale; _++) out.put(chance(rng, 0.5) ? 'L' : 'R');
+    out.write("\n\n");
+
+    int64_t next_id = 0;
+    for (auto [ghost, prime] : cycle_primes | views::enumerate){
+        const char tag = static_cast<char>('B' + ghost);
+        const std::string start = ghost == 0 ? "AAA" : std::string{tag, tag, 'A'};
+        const std::string end   = ghost == 0 ? "ZZZ" : std::string{tag, tag, 'Z'};
+
+        // A loop of cycle nodes reaches its end in cycle steps and then repeats every cycle steps
+        const int64_t cycle = prime*cycle_scale;
+        const std::string first = innerLabel(next_id);
+        out.print("{} = ({}, {})\n", start, first, first);
+        for (int64_t idx = 0; idx + 1 < cycle; idx++){
+            const std::string next = idx + 2 < cycle ? innerLabel(next_id + idx + 1) : end;
+            out.print("{} = ({}, {})\n", innerLabel(next_id + idx), next, next);
+        }
+        out.print("{} = ({}, {})\n", end, first, first);
+        next_id += cycle - 1;
+    }
+}
+
+static void generateDay9(Writer& out, Rng& rng, int64_t scale){
+    // Sequences are polynomials, built from random leading entries of their difference table
+    static constexpr int length = 21;
+    std::array<int64_t, 8> leading;
+    for (int64_t _ = 0; _ < 200*scale; _++){
+        const int64_t degree = uniform(rng, 0, leading.size() - 1);
+        for (int64_t& val : leading) val = uniform(rng, -9, 9);
+
+        for (int n : views::iota(0, length)){
+            int64_t val = 0;
+            int64_t binomial = 1;
+            for (int64_t k = 0; k <= std::min<int64_t>(degree, n); k++){
+                val += binomial*leading[k];
+                binomial = binomial*(n - k)/(k + 1);
+            }
+            out.print(n == 0 ? "{}" : " {}", val);
+        }
+        out.put('\n');
+    }
+}
+
+static void generateDay10(Writer& out, Rng& rng, int64_t scale){
+    static constexpr std::array<int, 4> dx{1, 0, -1, 0};
+    static constexpr std::array<int, 4> dy{0, 1, 0, -1};
+    static constexpr std::string_view junk = "|-LJ7F..";
+
+    // The pipe connecting the two given directions
+    auto pipe = [](Dir from, Dir to){
+        const int mask = (1 << from) | (1 << to);
+        switch (mask){
+            case (1 << NORTH) | (1 << SOUTH): return '|';
+            case (1 << EAST)  | (1 << WEST) : return '-';
+            case (1 << NORTH) | (1 << EAST) : return 'L';
+            case (1 << NORTH) | (1 << WEST) : return 'J';
+            case (1 << SOUTH) | (1 << WEST) : return '7';
+            default                         : return 'F';
+        }
+    };
+
+    const int side = gridSide(140, scale);
+    std::vector<std::string> grid(side, std::string(side, '.'));
+    for (std::string& row : grid){
+        ranges::generate(row, [&]{return junk[uniform(rng, 0, junk.size() - 1)];});
+    }
+
+    // The loop is a band fitting inside the grid with at least one tile to spare on each side
+    const int64_t span      = side - 4;
+    const int64_t max_step  = std::max<int64_t>(1, side/50);
+    const int64_t steps     = std::max<int64_t>(1, span/max_step - 1);
+    const int64_t thickness = max_step + uniform(rng, 1, max_step);
+    const std::vector<Edge> edges = bandOutline(rng, steps, max_step, thickness);
+
+    std::vector<Dir> moves;
+    for (const Edge& edge : edges) moves.insert(moves.end(), edge.length, edge.dir);
+    int64_t width = 0, height = 0, x = 0, y = 0;
+    for (Dir dir : moves){
+        x += dx[dir];
+        y += dy[dir];
+        width  = std::max(width, x);
+        height = std::max(height, y);
+    }
+
+    const int start_x = uniform(rng, 1, side - 2 - width);
+    const int start_y = uniform(rng, 1, side - 2 - height);
+    x = start_x;
+    y = start_y;
+    for (size_t idx = 0; idx < moves.size(); idx++){
+        const Dir from = static_cast<Dir>((moves[(idx + moves.size() - 1) % moves.size()] + 2) % 4);
+        grid[y][x] = pipe(from, moves[idx]);
+        x += dx[moves[idx]];
+        y += dy[moves[idx]];
+    }
+
+    // Nothing outside the loop may look like it connects to S
+    grid[start_y][start_x]     = 'S';
+    grid[start_y][start_x - 1] = '.';
+    grid[start_y - 1][start_x] = '.';
+    for (const std::string& row : grid){
+        out.write(row);
+        out.put('\n');
+    }
+}
+
+static void generateDay11(Writer& out, Rng& rng, int64_t scale){
+    const int side = gridSide(140, scale);
+    std::vector<bool> empty_cols(side);
+    for (auto&& col : empty_cols) col = chance(rng, 0.05);
+
+    std::string row(side, '.');
+    for (int _ : views::iota(0, side)){
+        const bool empty_row = chance(rng, 0.05);
+        for (int x : views::iota(0, side)){
+            row[x] = !empty_row && !empty_cols[x] && chance(rng, 0.02) ? '#' : '.';
+        }
+        out.write(row);
+        out.put('\n');
+    }
+}
+
+static void generateDay12(Writer& out, Rng& rng, int64_t scale){
+    std::string springs;
+    std::vector<int> chunks;
+    for (int64_t _ = 0; _ < 1000*scale; _++){
+        springs.resize(uniform(rng, 6, 20));
+        ranges::generate(springs, [&]{return chance(rng, 0.5) ? '#' : '.';});
+        springs[uniform(rng, 0, springs.size() - 1)] = '#';
+
+        // Record the true groups before hiding some of the springs
+        chunks.clear();
+        for (auto group : springs | views::chunk_by(std::equal_to{})){
+            if (group.front() == '#') chunks.push_back(ranges::distance(group));
+        }
+        for (char& c : springs){
+            if (chance(rng, 0.45)) c = '?';
+        }
+
+        out.write(springs);
+        for (auto [idx, chunk] : chunks | views::enumerate) out.print(idx == 0 ? " {}" : ",{}", chunk);
+        out.put('\n');
+    }
+}
+
+// Random pattern with a reflection between two rows, smudged by flipping one mirrored cell
+static std::vector<std::string> smudgedPattern(Rng& rng, int width, int height){
+    std::vector<std::string> rows(height, std::string(width, '.'));
+    for (std::string& row : rows){
+        ranges::generate(row, [&]{return chance(rng, 0.5) ? '#' : '.';});
+    }
+
+    const int mirror = uniform(rng, 0, height - 2);
+    const int reach  = std::min(mirror, height - 2 - mirror);
+    for (int k = 0; k <= reach; k++) rows[mirror + 1 + k] = rows[mirror - k];
+
+    char& smudge = rows[mirror + 1 + uniform(rng, 0, reach)][uniform(rng, 0, width - 1)];
+    smudge = smudge == '#' ? '.' : '#';
+    return rows;
+}
+
+static void generateDay13(Writer& out, Rng& rng, int64_t scale){
+    for (int64_t pattern = 0; pattern < 100*scale; pattern++){
+        const int width  = uniform(rng, 5, 17);
+        const int height = uniform(rng, 5, 17);
+
+        // Half the patterns reflect between columns, built as a transposed row reflection
+        std::vector<std::string> rows;
+        if (chance(rng, 0.5)){
+            rows = smudgedPattern(rng, width, height);
+        }else{
+            const std::vector<std::string> cols = smudgedPattern(rng, height, width);
+            rows.assign(height, std::string(width, '.'));
+            for (int y : views::iota(0, height)){
+                for (int x : views::iota(0, width)) rows[y][x] = cols[x][y];
+            }
+        }
+
+        if (pattern > 0) out.put('\n');
+        for (const std::string& row : rows){
+            out.write(row);
+            out.put('\n');
+        }
+    }
+}
+
+static void generateDay14(Writer& out, Rng& rng, int64_t scale){
+    writeGrid(out, rng, gridSide(100, scale), [](Rng& rng){
+        const int64_t roll = uniform(rng, 0, 99);
+        return roll < 20 ? 'O' : roll < 38 ? '#' : '.';
+    });
+}
+
+static void generateDay15(Writer& out, Rng& rng, int64_t scale){
+    // Steps reuse labels from a shared pool so lenses get replaced and removed
+    const int64_t label_pool = std::max<int64_t>(50, 250*scale);
+    for (int64_t step = 0; step < 4000*scale; step++){
+        if (step > 0) out.put(',');
+        out.write(lowercaseLabel(uniform(rng, 0, label_pool - 1)));
+        if (chance(rng, 0.6)) out.print("={}", uniform(rng, 1, 9));
+        else out.put('-');
+    }
+    out.put('\n');
+}
+
+static void generateDay16(Writer& out, Rng& rng, int64_t scale){
+    static constexpr std::string_view devices = "/\\|-";
+    writeGrid(out, rng, gridSide(110, scale), [](Rng& rng){
+        return chance(rng, 0.12) ? devices[uniform(rng, 0, devices.size() - 1)] : '.';
+    });
+}
+
+static void generateDay17(Writer& out, Rng& rng, int64_t scale){
+    writeGrid(out, rng, gridSide(141, scale), [](Rng& rng){
+        return static_cast<char>('1' + uniform(rng, 0, 8));
+    });
+}
+
+static void generateDay18(Writer& out, Rng& rng, int64_t scale){
+    // Both plans are bands with the same turns, so every line carries a direction and a
+    // length for each part. Part 2 steps shrink as the plan grows to keep the area in 64 bits
+    static constexpr std::string_view dir_labels = "RDLU";
+    const int64_t steps = 175*scale;
+    const int64_t part2_step = std::clamp<int64_t>(2'000'000'000'000 / steps, 16, 500'000);
+
+    const std::vector<Edge> part1 = bandOutline(rng, steps, 10, uniform(rng, 11, 20));
+    const std::vector<Edge> part2 = bandOutline(rng, steps, part2_step, part2_step + uniform(rng, 1, part2_step));
+    for (auto [edge1, edge2] : views::zip(part1, part2)){
+        out.print("{} {} (#{:05x}{})\n", dir_labels[edge1.dir], edge1.length, edge2.length, static_cast<int>(edge2.dir));
+    }
+}
+
+static void generateDay19(Writer& out, Rng& rng, int64_t scale){
+    // Workflows form a tree rooted at "in", created breadth first until the target count is
+    // reached. Each one's final destination is forced to be new while nothing else is pending
+    static constexpr std::string_view categories = "xmas";
+    const int64_t target = 550*scale;
+
+    std::deque<std::string> pending{"in"};
+    int64_t created = 1;
+    int64_t next_id = 0;
+    auto destination = [&](bool force_new) -> std::string {
+        if (created < target && (force_new || chance(rng, 0.5))){
+            std::string label = lowercaseLabel(next_id++);
+            if (label == "in") label = lowercaseLabel(next_id++);
+            pending.push_back(label);
+            created++;
+            return label;
+        }
+        return chance(rng, 0.5) ? "A" : "R";
+    };
+
+    while (!pending.empty()){
+        const std::string label = std::move(pending.front());
+        pending.pop_front();
+        out.print("{}{{", label);
+        for (int64_t _ = 0, rules = uniform(rng, 1, 4); _ < rules; _++){
+            const char category = categories[uniform(rng, 0, 3)];
+            const char comparison = chance(rng, 0.5) ? '<' : '>';
+            const int64_t limit = uniform(rng, 1, 4000);
+            out.print("{}{}{}:{},", category, comparison, limit, destination(false));
+        }
+        out.print("{}}}\n", destination(pending.empty()));
+    }
+
+    out.put('\n');
+    for (int64_t _ = 0; _ < 200*scale; _++){
+        out.print("{{x={},m={},a={},s={}}}\n",
+            uniform(rng, 1, 4000), uniform(rng, 1, 4000), uniform(rng, 1, 4000), uniform(rng, 1, 4000));
+    }
+}
+
+static void generateDay20(Writer& out, Rng& rng, int64_t scale){
+    // The broadcaster drives independent 12 bit ripple counters built from flip-flops. Each
+    // counter's conjunction watches the bits set in its period and feeds an inverter, so the
+    // inverter first sends a high pulse on that press. The first chain's inverter is "ln",
+    // the module part 2 watches, and every inverter feeds a final conjunction into rx
+    static constexpr int chain_bits = 12;
+    const int64_t chains = 4*scale;
+
+    auto flipFlop = [](int64_t chain, int bit){return "f" + lowercaseLabel(chain*chain_bits + bit);};
+    auto counter  = [](int64_t chain){return "c" + lowercaseLabel(chain);};
+    auto inverter = [](int64_t chain){return chain == 0 ? std::string("ln") : "v" + lowercaseLabel(chain);};
+
+    out.write("broadcaster ->");
+    for (int64_t chain = 0; chain < chains; chain++) out.print("{} {}", chain == 0 ? "" : ",", flipFlop(chain, 0));
+    out.put('\n');
+
+    for (int64_t chain = 0; chain < chains; chain++){
+        const int64_t period = uniform(rng, 1 << (chain_bits - 1), (1 << chain_bits) - 1) | 1;
+        for (int bit = 0; bit < chain_bits; bit++){
+            const bool next = bit + 1 < chain_bits;
+            const bool watched = (period >> bit) & 1;
+            out.print("%{} -> {}{}{}\n",
+                flipFlop(chain, bit),
+                next ? flipFlop(chain, bit + 1) : "",
+                next && watched ? ", " : "",
+                watched ? counter(chain) : "");
+        }
+        out.print("&{} -> {}\n", counter(chain), inverter(chain));
+        out.print("&{} -> hub\n", inverter(chain));
+    }
+    out.write("&hub -> rx\n");
+}
+
+struct Generator{
+    int day;
+    void (*generate)(Writer&, Rng&, int64_t);
+};
+
+static constexpr std::array<Generator, 20> generators{{
+    {1,  generateDay1},  {2,  generateDay2},  {3,  generateDay3},  {4,  generateDay4},  {5,  generateDay5},
+    {6,  generateDay6},  {7,  generateDay7},  {8,  generateDay8},  {9,  generateDay9},  {10, generateDay10},
+    {11, generateDay11}, {12, generateDay12}, {13, generateDay13}, {14, generateDay14}, {15, generateDay15},
+    {16, generateDay16}, {17, generateDay17}, {18, generateDay18}, {19, generateDay19}, {20, generateDay20},
+}};
+
+struct Options{
+    std::vector<int> days;
+    int64_t scale = 1;
+    uint64_t seed = 2023;
+    std::filesystem::path out_dir = ".";
+};
+
+static void printUsage(){
+    std::println(stderr, "Usage: aoc_gen [--days 1,5,9-20] [--scale N] [--seed N] [--out DIR]");
+    std::println(stderr, "  --days   Days to generate, as a comma separated list of days or ranges (default all)");
+    std::println(stderr, "  --scale  Size relative to a puzzle input, e.g. 10, 1000 or 1000000 (default 1)");
+    std::println(stderr, "  --seed   Seed for the random generator, the same seed gives the same files (default 2023)");
+    std::println(stderr, "  --out    Directory to write day_N_data.txt into (default the working directory)");
+}
+
+static std::optional<Options> parseArgs(int argc, char** argv){
+    Options options;
+    for (int idx = 1; idx < argc; idx++){
+        std::string_view arg(argv[idx]);
+        const bool has_value = idx + 1 < argc;
+        if (arg == "--days" && has_value){
+            if (!aoc::parseDays(argv[++idx], options.days)) return {};
+        }else if (arg == "--scale" && has_value){
+            if (!aoc::parseInt(argv[++idx], options.scale) || options.scale < 1) return {};
+        }else if (arg == "--seed" && has_value){
+            if (!aoc::parseInt(argv[++idx], options.seed)) return {};
+        }else if (arg == "--out" && has_value){
+            options.out_dir = argv[++idx];
+        }else{
+            return {};
+        }
+    }
+    return options;
+}
+
+int main(int argc, char** argv){
+    std::optional<Options> options = parseArgs(argc, argv);
+    if (!options){
+        printUsage();
+        return 1;
+    }
+    if (std::optional<int> day = aoc::unknownDay(options->days, generators, &Generator::day)){
+        std::println(stderr, "There is no generator for day {}", *day);
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options->out_dir, error);
+    for (const Generator& generator : generators){
+        if (!options->days.empty() && !ranges::contains(options->days, generator.day)) continue;
+
+        // Seeding per day keeps each file the same whichever other days are generated
+        std::seed_seq seed{
+            static_cast<uint32_t>(options->seed),
+            static_cast<uint32_t>(options->seed >> 32),
+            static_cast<uint32_t>(generator.day)
+        };
+        Rng rng(seed);
+
+        const std::filesystem::path path = options->out_dir / std::format("day_{}_data.txt", generator.day);
+        Writer out(path);
+        const auto start = Clock::now();
+        generator.generate(out, rng, options->scale);
+        const size_t bytes = out.bytesWritten();
+        if (!out.close()){
+            std::println(stderr, "Failed to write {}", path.string());
+            return 1;
+        }
+        const auto stop = Clock::now();
+        std::println("day {:>2}: {} bytes to {} in {:.2f} s", generator.day, bytes, path.string(),
+            std::chrono::duration<double>(stop - start).count());
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// Saved aoc_bench results to compare later runs against. The file is plain text, one
+// line per day and phase after a version line:
+//
+//     aoc-baseline 1
+//     17 solve 20 5120.4 5098.2 1893.6
+//
+// holding the day, phase, sample count, median, mean and sample variance in microseconds
+
+#include <print>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <algorithm>
+#include <filesystem>
+
+#include "bench_stats.hpp"
+
+namespace aoc{
+
+struct BaselineEntry{
+    int day = 0;
+    std::string phase;
+    PhaseStats stats;
+};
+
+static constexpr int baseline_version = 1;
+
+static inline bool saveBaseline(const std::filesystem::path& path, const std::vector<BaselineEntry>& entries){
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+    std::println(file, "aoc-baseline {}", baseline_version);
+    for (const BaselineEntry& entry : entries){
+        std::println(file, "{} {} {} {} {} {}", entry.day, entry.phase, entry.stats.count, entry.stats.median, entry.stats.mean, entry.stats.variance);
+    }
+    return std::fclose(file) == 0;
+}
+
+// Empty if the file is missing, from another version or malformed
+static inline std::optional<std::vector<BaselineEntry>> loadBaseline(const std::filesystem::path& path){
+    std::ifstream file(path);
+    std::string magic;
+    int version = 0;
+    if (!(file >> magic >> version) || magic != "aoc-baseline" || version != baseline_version) return {};
+
+    std::vector<BaselineEntry> entries;
+    BaselineEntry entry;
+    while (file >> entry.day >> entry.phase >> entry.stats.count >> entry.stats.median >> entry.stats.mean >> entry.stats.variance){
+        entries.push_back(entry);
+    }
+    if (!file.eof()) return {};
+    return entries;
+}
+
+static inline const BaselineEntry* findBaseline(const std::vector<BaselineEntry>& entries, int day, std::string_view phase){
+    auto it = std::ranges::find_if(entries, [&](const BaselineEntry& entry){return entry.day == day && entry.phase == phase;});
+    return it == entries.end() ? nullptr : &*it;
+}
+
+// A phase regressed when its median slowed by more than threshold (a fraction, 0.05 for
+// 5%) and Welch's test says the slowdown is unlikely to be noise at significance alpha
+static inline bool isRegression(const PhaseStats& before, const PhaseStats& after, double threshold, double alpha){
+    return after.median > before.median * (1.0 + threshold) && welchSlowerPValue(before, after) < alpha;
+}
+
+} // namespace aoc
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace aoc{
+
+// Summary of the repeated timings of one phase, all in microseconds
+struct PhaseStats{
+    size_t count    = 0;
+    double min      = 0.0;
+    double median   = 0.0;
+    double p99      = 0.0;
+    double mean     = 0.0;
+    double variance = 0.0;  // Sample variance, zero for a single sample
+};
+
+// Nearest rank percentile of an already sorted sample set
+static inline double percentile(const std::vector<double>& sorted, double fraction){
+    if (sorted.empty()) return 0.0;
+    const size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+static inline PhaseStats summarize(std::vector<double> samples){
+    if (samples.empty()) return {};
+    std::ranges::sort(samples);
+    double sum = 0.0;
+    for (double sample : samples) sum += sample;
+    const double mean = sum / samples.size();
+    double squares = 0.0;
+    for (double sample : samples) squares += (sample - mean) * (sample - mean);
+    return PhaseStats{
+        .count    = samples.size(),
+        .min      = samples.front(),
+        .median   = percentile(samples, 0.5),
+        .p99      = percentile(samples, 0.99),
+        .mean     = mean,
+        .variance = samples.size() > 1 ? squares / (samples.size() - 1) : 0.0
+    };
+}
+
+// Regularized incomplete beta function I_x(a, b), by Lentz's continued fraction
+static inline double incompleteBeta(double a, double b, double x){
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    // The fraction converges quickly only below the mean, use the symmetry above it
+    if (x > (a + 1.0) / (a + b + 2.0)) return 1.0 - incompleteBeta(b, a, 1.0 - x);
+
+    constexpr double tiny = 1e-300;
+    const double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a*std::log(x) + b*std::log1p(-x)) / a;
+    double f = 1.0, c = 1.0, d = 0.0;
+    for (int idx = 0; idx <= 400; idx++){
+        const int m = idx / 2;
+        double numerator;
+        if (idx == 0) numerator = 1.0;
+        else if (idx % 2 == 0) numerator = (m * (b - m) * x) / ((a + 2.0*m - 1.0) * (a + 2.0*m));
+        else numerator = -((a + m) * (a + b + m) * x) / ((a + 2.0*m) * (a + 2.0*m + 1.0));
+
+        d = 1.0 + numerator * d;
+        d = std::abs(d) < tiny ? 1.0 / tiny : 1.0 / d;
+        c = 1.0 + numerator / c;
+        if (std::abs(c) < tiny) c = tiny;
+        f *= c * d;
+        if (std::abs(1.0 - c*d) < 1e-12) break;
+    }
+    return front * (f - 1.0);
+}
+
+// P(T > t) for Student's t distribution with df degrees of freedom
+static inline double studentTUpperTail(double t, double df){
+    const double tail = 0.5 * incompleteBeta(df / 2.0, 0.5, df / (df + t*t));
+    return t > 0.0 ? tail : 1.0 - tail;
+}
+
+// One sided Welch's t-test that after has a larger mean than before, without assuming
+// equal variances. Returns the p-value, small when after is reliably slower
+static inline double welchSlowerPValue(const PhaseStats& before, const PhaseStats& after){
+    if (before.count < 2 || after.count < 2) return 1.0;
+    const double before_term = before.variance / before.count;
+    const double after_term  = after.variance / after.count;
+    const double standard_error = std::sqrt(before_term + after_term);
+    if (standard_error == 0.0) return after.mean > before.mean ? 0.0 : 1.0;
+
+    const double t  = (after.mean - before.mean) / standard_error;
+    const double df = (before_term + after_term) * (before_term + after_term)
+                    / (before_term*before_term / (before.count - 1) + after_term*after_term / (after.count - 1));
+    return studentTUpperTail(t, df);
+}
+
+} // namespace aoc
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <ranges>
+#include <charconv>
+#include <optional>
+#include <algorithm>
+#include <concepts>
+#include <string_view>
+
+namespace aoc{
+
+// Parse the whole of str as an integer, failing on any trailing characters
+template<std::integral Int>
+static inline bool parseInt(std::string_view str, Int& val){
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), val);
+    return ec == std::errc{} && ptr == str.data() + str.size();
+}
+
+template<std::floating_point Float>
+static inline bool parseFloat(std::string_view str, Float& val){
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), val);
+    return ec == std::errc{} && ptr == str.data() + str.size();
+}
+
+// Advent of Code runs from day 1 to day 25. A tool checks the days it actually has with
+// unknownDay
+static constexpr int first_day = 1;
+static constexpr int last_day  = 25;
+
+// Accepts lists such as "1,5,9-20". Days must lie within [first_day, last_day] and a range
+// must not run backwards
+static inline bool parseDays(std::string_view list, std::vector<int>& days){
+    for (auto item : list | std::views::split(',')){
+        std::string_view range(item);
+        int first = 0, last = 0;
+        size_t dash = range.find('-');
+        if (dash == std::string_view::npos){
+            if (!parseInt(range, first)) return false;
+            last = first;
+        }else if (!parseInt(range.substr(0, dash), first) || !parseInt(range.substr(dash+1), last)){
+            return false;
+        }
+        if (first < first_day || last > last_day || first > last) return false;
+        for (int day : std::views::iota(first, last+1)) days.push_back(day);
+    }
+    return true;
+}
+
+// The first of days that no entry of known has, where day_of gives an entry's day
+template<std::ranges::input_range Known, typename Proj>
+static inline std::optional<int> unknownDay(const std::vector<int>& days, const Known& known, Proj day_of){
+    for (int day : days) if (!std::ranges::contains(known, day, day_of)) return day;
+    return {};
+}
+
+} // namespace aoc
@@ -0,0 +1,57 @@
+// Replacement global operator new and delete that feed aoc::memory::counters(). Only
+// linked in when configured with -DAOC_MEMORY_PROFILE=ON. Sizes are taken from
+// malloc_usable_size so a free is charged exactly what its allocation was
+
+#include <new>
+#include <cstdlib>
+
+#include <malloc.h>
+
+#include "memory_profile.hpp"
+
+static void* allocate(size_t size, size_t alignment){
+    if (size == 0) size = 1;
+    void* ptr = alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__ ?
+        std::malloc(size) :
+        std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (ptr) aoc::memory::counters().recordAlloc(::malloc_usable_size(ptr));
+    return ptr;
+}
+
+static void* allocateOrThrow(size_t size, size_t alignment){
+    while (true){
+        if (void* ptr = allocate(size, alignment)) return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+static void release(void* ptr) noexcept {
+    if (!ptr) return;
+    aoc::memory::counters().recordFree(::malloc_usable_size(ptr));
+    std::free(ptr);
+}
+
+void* operator new(size_t size){return allocateOrThrow(size, 0);}
+void* operator new[](size_t size){return allocateOrThrow(size, 0);}
+void* operator new(size_t size, std::align_val_t align){return allocateOrThrow(size, static_cast<size_t>(align));}
+void* operator new[](size_t size, std::align_val_t align){return allocateOrThrow(size, static_cast<size_t>(align));}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {return allocate(size, 0);}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {return allocate(size, 0);}
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {return allocate(size, static_cast<size_t>(align));}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {return allocate(size, static_cast<size_t>(align));}
+
+void operator delete(void* ptr) noexcept {release(ptr);}
+void operator delete[](void* ptr) noexcept {release(ptr);}
+void operator delete(void* ptr, size_t) noexcept {release(ptr);}
+void operator delete[](void* ptr, size_t) noexcept {release(ptr);}
+void operator delete(void* ptr, std::align_val_t) noexcept {release(ptr);}
+void operator delete[](void* ptr, std::align_val_t) noexcept {release(ptr);}
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {release(ptr);}
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {release(ptr);}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {release(ptr);}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {release(ptr);}
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {release(ptr);}
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {release(ptr);}
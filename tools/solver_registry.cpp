@@ -0,0 +1,33 @@
+#include "solver.hpp"
+
+// Each day's solver library provides one of these
+namespace day1 {aoc::Solver solver();}
+namespace day2 {aoc::Solver solver();}
+namespace day3 {aoc::Solver solver();}
+namespace day4 {aoc::Solver solver();}
+namespace day5 {aoc::Solver solver();}
+namespace day6 {aoc::Solver solver();}
+namespace day7 {aoc::Solver solver();}
+namespace day8 {aoc::Solver solver();}
+namespace day9 {aoc::Solver solver();}
+namespace day10{aoc::Solver solver();}
+namespace day11{aoc::Solver solver();}
+namespace day12{aoc::Solver solver();}
+namespace day13{aoc::Solver solver();}
+namespace day14{aoc::Solver solver();}
+namespace day15{aoc::Solver solver();}
+namespace day16{aoc::Solver solver();}
+namespace day17{aoc::Solver solver();}
+namespace day18{aoc::Solver solver();}
+namespace day19{aoc::Solver solver();}
+namespace day20{aoc::Solver solver();}
+
+const std::vector<aoc::Solver>& aoc::allSolvers(){
+    static const std::vector<Solver> solvers{
+        day1::solver(),  day2::solver(),  day3::solver(),  day4::solver(),  day5::solver(),
+        day6::solver(),  day7::solver(),  day8::solver(),  day9::solver(),  day10::solver(),
+        day11::solver(), day12::solver(), day13::solver(), day14::solver(), day15::solver(),
+        day16::solver(), day17::solver(), day18::solver(), day19::solver(), day20::solver(),
+    };
+    return solvers;
+}